@@ -0,0 +1,2323 @@
+// libuncurl - public domain; see uncurl.h
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <glob.h>
+#include <sched.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "uncurl.h"
+
+#define ARRAY_LENGTH(xs) (sizeof(xs) / sizeof(xs[0]))
+#define N_COMP (UNCURL_N_COMP)
+
+uint8_t* uncurl_read_entire_file(const char* path, size_t* out_size)
+{
+	FILE* in;
+	if (strcmp(path, "-") == 0) {
+		in = stdin;
+	} else {
+		in = fopen(path, "rb");
+		if (in == NULL) return NULL;
+	}
+
+	const size_t chunk_size = (1<<20);
+	uint8_t* data = NULL;
+	size_t n=0, cap=0;
+	for (;;) {
+		const size_t req_cap = n + chunk_size;
+		if (cap < req_cap) {
+			uint8_t* grown = realloc(data, req_cap);
+			if (grown == NULL) {
+				free(data);
+				data = NULL;
+				break;
+			}
+			data = grown;
+			cap = req_cap;
+		}
+		const size_t n_read = fread(data+n, 1, chunk_size, in);
+		n += n_read;
+		if (n_read < chunk_size) {
+			if (ferror(in)) {
+				free(data);
+				data = NULL;
+			}
+			break;
+		}
+	}
+	if (in != stdin) fclose(in);
+	if (data == NULL) return NULL;
+	if (out_size != NULL) *out_size = n;
+	return data;
+}
+
+int uncurl_parse_size(const char* s, size_t* out_size)
+{
+	char* end = NULL;
+	const unsigned long long v = strtoull(s, &end, 10);
+	if (end == s) return 0;
+	int shift = 0;
+	switch (*end) {
+	case 0: break;
+	case 'k': case 'K': shift = 10; end++; break;
+	case 'm': case 'M': shift = 20; end++; break;
+	case 'g': case 'G': shift = 30; end++; break;
+	case 't': case 'T': shift = 40; end++; break;
+	default: return 0;
+	}
+	if (*end != 0) return 0;
+	if (out_size) *out_size = (size_t)v << shift;
+	return 1;
+}
+
+int uncurl_n_cpus(void)
+{
+#ifdef __linux__
+	// honours taskset and cgroup cpusets, unlike the online count
+	cpu_set_t set;
+	if (sched_getaffinity(0, sizeof set, &set) == 0 && CPU_COUNT(&set) > 0) return CPU_COUNT(&set);
+#endif
+	const long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? n : 1;
+}
+
+// the pool: one worker per core (less the caller's), each with a deque of
+// tasks per priority. a task is a range of a batch's jobs; whoever runs it
+// keeps splitting off the upper half onto its own deque until one job is
+// left, so owners work through their deques newest first (neighbouring
+// jobs, warm caches) while idle workers steal the oldest, biggest ranges
+// from the other end. threads waiting for a batch only help with that
+// batch, so a wait never gets stuck behind someone else's long job.
+
+#define POOL_MAX_WORKERS (1024)
+
+struct uncurl_batch {
+	void (*fn)(void* usr, int job);
+	void* usr;
+	enum uncurl_priority priority;
+	atomic_int is_cancelled;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int n_pending; // jobs not yet run (or skipped)
+	int n_refs; // the submitter's, and one while jobs are pending
+};
+
+struct pool_task {
+	struct uncurl_batch* batch;
+	int job0, job1;
+};
+
+struct pool_deque {
+	struct pool_task* tasks; // ring buffer
+	int head, cap;
+	atomic_int n; // changed with the lock held, but peeked at without
+};
+
+struct pool_worker {
+	pthread_mutex_t mutex;
+	struct pool_deque deques[UNCURL_N_PRIORITIES];
+};
+
+static struct {
+	pthread_once_t once;
+	int n_workers;
+	// workers[n_workers] is shared by threads outside the pool
+	struct pool_worker workers[POOL_MAX_WORKERS + 1];
+	atomic_int n_queued;
+	atomic_int n_sleeping;
+	pthread_mutex_t sleep_mutex;
+	pthread_cond_t wake_cond;
+} pool = { .once = PTHREAD_ONCE_INIT };
+
+static _Thread_local int pool_worker_index = -1;
+static _Thread_local enum uncurl_priority pool_current_priority = UNCURL_PRIORITY_VISIBLE;
+
+static void deque_push(struct pool_deque* dq, struct pool_task task)
+{
+	if (dq->n == dq->cap) {
+		const int cap = dq->cap > 0 ? 2*dq->cap : 16;
+		struct pool_task* tasks = malloc(cap * sizeof *tasks);
+		assert(tasks != NULL);
+		for (int i = 0; i < dq->n; i++) tasks[i] = dq->tasks[(dq->head + i) % dq->cap];
+		free(dq->tasks);
+		dq->tasks = tasks;
+		dq->head = 0;
+		dq->cap = cap;
+	}
+	dq->tasks[(dq->head + dq->n++) % dq->cap] = task;
+}
+
+static struct pool_task deque_remove(struct pool_deque* dq, int i)
+{
+	const struct pool_task task = dq->tasks[(dq->head + i) % dq->cap];
+	if (i == 0) {
+		dq->head = (dq->head + 1) % dq->cap;
+	} else {
+		for (int j = i; j < dq->n-1; j++) dq->tasks[(dq->head + j) % dq->cap] = dq->tasks[(dq->head + j + 1) % dq->cap];
+	}
+	dq->n--;
+	return task;
+}
+
+static void pool_push(struct pool_task task)
+{
+	const int w = pool_worker_index >= 0 ? pool_worker_index : pool.n_workers;
+	struct pool_worker* wk = &pool.workers[w];
+	pthread_mutex_lock(&wk->mutex);
+	deque_push(&wk->deques[task.batch->priority], task);
+	pthread_mutex_unlock(&wk->mutex);
+	atomic_fetch_add(&pool.n_queued, 1);
+	if (atomic_load(&pool.n_sleeping) > 0) {
+		pthread_mutex_lock(&pool.sleep_mutex);
+		pthread_cond_signal(&pool.wake_cond);
+		pthread_mutex_unlock(&pool.sleep_mutex);
+	}
+}
+
+// takes a task: the newest of our own, or the oldest of someone else's;
+// visible ones first. with only_batch, only that batch's tasks are taken
+static int pool_take(struct uncurl_batch* only_batch, struct pool_task* out)
+{
+	const int n = pool.n_workers + 1;
+	const int self = pool_worker_index >= 0 ? pool_worker_index : pool.n_workers;
+	for (int prio = UNCURL_N_PRIORITIES-1; prio >= 0; prio--) {
+		if (only_batch != NULL && only_batch->priority != prio) continue;
+		for (int k = 0; k < n; k++) {
+			struct pool_worker* wk = &pool.workers[(self + k) % n];
+			struct pool_deque* dq = &wk->deques[prio];
+			if (atomic_load_explicit(&dq->n, memory_order_relaxed) == 0) continue;
+			pthread_mutex_lock(&wk->mutex);
+			int found = -1;
+			if (only_batch == NULL) {
+				if (dq->n > 0) found = k == 0 ? dq->n-1 : 0;
+			} else {
+				for (int i = dq->n-1; i >= 0 && found == -1; i--) {
+					if (dq->tasks[(dq->head + i) % dq->cap].batch == only_batch) found = i;
+				}
+			}
+			if (found != -1) *out = deque_remove(dq, found);
+			pthread_mutex_unlock(&wk->mutex);
+			if (found != -1) {
+				atomic_fetch_sub(&pool.n_queued, 1);
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static void batch_release(struct uncurl_batch* b, int n_done)
+{
+	pthread_mutex_lock(&b->mutex);
+	int is_last = 0;
+	if (n_done > 0) {
+		b->n_pending -= n_done;
+		if (b->n_pending == 0) {
+			pthread_cond_broadcast(&b->cond);
+			is_last = (--b->n_refs == 0);
+		}
+	} else {
+		is_last = (--b->n_refs == 0);
+	}
+	pthread_mutex_unlock(&b->mutex);
+	if (is_last) {
+		pthread_mutex_destroy(&b->mutex);
+		pthread_cond_destroy(&b->cond);
+		free(b);
+	}
+}
+
+static void pool_run(struct pool_task task)
+{
+	struct uncurl_batch* b = task.batch;
+	while (task.job1 - task.job0 > 1) {
+		const int mid = task.job0 + (task.job1 - task.job0) / 2;
+		pool_push((struct pool_task){ .batch = b, .job0 = mid, .job1 = task.job1 });
+		task.job1 = mid;
+	}
+	const enum uncurl_priority prev = pool_current_priority;
+	// nested batches inherit the priority
+	pool_current_priority = b->priority;
+	if (!atomic_load(&b->is_cancelled)) b->fn(b->usr, task.job0);
+	pool_current_priority = prev;
+	batch_release(b, 1);
+}
+
+static void* pool_worker_thread(void* usr)
+{
+	pool_worker_index = (int)(intptr_t)usr;
+	pthread_mutex_lock(&pool.sleep_mutex);
+	pthread_mutex_unlock(&pool.sleep_mutex);
+	for (;;) {
+		struct pool_task task;
+		if (pool_take(NULL, &task)) {
+			pool_run(task);
+			continue;
+		}
+		pthread_mutex_lock(&pool.sleep_mutex);
+		atomic_fetch_add(&pool.n_sleeping, 1);
+		while (atomic_load(&pool.n_queued) == 0) pthread_cond_wait(&pool.wake_cond, &pool.sleep_mutex);
+		atomic_fetch_sub(&pool.n_sleeping, 1);
+		pthread_mutex_unlock(&pool.sleep_mutex);
+	}
+	return NULL;
+}
+
+static void pool_init(void)
+{
+	pthread_mutex_init(&pool.sleep_mutex, NULL);
+	pthread_cond_init(&pool.wake_cond, NULL);
+	for (int i = 0; i <= POOL_MAX_WORKERS; i++) pthread_mutex_init(&pool.workers[i].mutex, NULL);
+	// the threads that wait for batches make up for the missing worker,
+	// but someone has to run the batches nobody waits for
+	int n = uncurl_n_cpus() - 1;
+	if (n < 1) n = 1;
+	if (n > POOL_MAX_WORKERS) n = POOL_MAX_WORKERS;
+	// workers start by taking sleep_mutex, so they see the final count
+	pthread_mutex_lock(&pool.sleep_mutex);
+	pool.n_workers = n;
+	for (int i = 0; i < n; i++) {
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, pool_worker_thread, (void*)(intptr_t)i) != 0) {
+			// make do with the ones we got (if none, see uncurl_submit())
+			pool.n_workers = i;
+			break;
+		}
+		pthread_detach(thread);
+	}
+	pthread_mutex_unlock(&pool.sleep_mutex);
+}
+
+struct uncurl_batch* uncurl_submit(int n_jobs, void (*fn)(void* usr, int job), void* usr, enum uncurl_priority priority)
+{
+	pthread_once(&pool.once, pool_init);
+	struct uncurl_batch* b = calloc(1, sizeof *b);
+	assert(b != NULL);
+	b->fn = fn;
+	b->usr = usr;
+	b->priority = priority;
+	pthread_mutex_init(&b->mutex, NULL);
+	pthread_cond_init(&b->cond, NULL);
+	b->n_pending = n_jobs;
+	b->n_refs = n_jobs > 0 ? 2 : 1;
+	if (n_jobs > 0) pool_push((struct pool_task){ .batch = b, .job0 = 0, .job1 = n_jobs });
+	// without workers nobody else would run it
+	if (pool.n_workers == 0) uncurl_batch_wait(b);
+	return b;
+}
+
+void uncurl_batch_cancel(struct uncurl_batch* b)
+{
+	atomic_store(&b->is_cancelled, 1);
+}
+
+int uncurl_batch_is_done(struct uncurl_batch* b)
+{
+	pthread_mutex_lock(&b->mutex);
+	const int is_done = (b->n_pending == 0);
+	pthread_mutex_unlock(&b->mutex);
+	return is_done;
+}
+
+void uncurl_batch_wait(struct uncurl_batch* b)
+{
+	for (;;) {
+		struct pool_task task;
+		if (pool_take(b, &task)) {
+			pool_run(task);
+			continue;
+		}
+		// the rest is running elsewhere; whatever those threads split off
+		// they'll run themselves if nobody steals it
+		pthread_mutex_lock(&b->mutex);
+		const int is_done = (b->n_pending == 0);
+		if (!is_done) pthread_cond_wait(&b->cond, &b->mutex);
+		pthread_mutex_unlock(&b->mutex);
+		if (is_done) return;
+	}
+}
+
+void uncurl_batch_release(struct uncurl_batch* b)
+{
+	batch_release(b, 0);
+}
+
+void uncurl_parallel_for(int n_jobs, void (*fn)(void* usr, int job), void* usr)
+{
+	if (n_jobs <= 0) return;
+	if (n_jobs == 1) {
+		fn(usr, 0);
+		return;
+	}
+	struct uncurl_batch* b = uncurl_submit(n_jobs, fn, usr, pool_current_priority);
+	uncurl_batch_wait(b);
+	uncurl_batch_release(b);
+}
+
+struct lindenmayer_system_stack_entry {
+	int rule_index;
+	int pc;
+};
+
+struct lindenmayer_system_rule {
+	const char* ops;
+	int length;
+};
+
+struct lindenmayer_system {
+	int n_rules;
+	struct lindenmayer_system_rule rules[1<<8];
+	int depth;
+	struct lindenmayer_system_stack_entry stack[1<<8];
+	int stack_height;
+	int state;
+	int x,y,direction;
+};
+
+static void lindenmayer_system_init(struct lindenmayer_system* lsys, int n_rules, const char** rules, int depth)
+{
+	assert(n_rules <= ARRAY_LENGTH(lsys->rules));
+	memset(lsys, 0, sizeof *lsys);
+	lsys->depth = depth;
+	lsys->n_rules = n_rules;
+	for (int i = 0; i < n_rules; i++) {
+		struct lindenmayer_system_rule* rule = &lsys->rules[i];
+		rule->ops = strdup(rules[i]);
+		rule->length = strlen(rule->ops);
+	}
+}
+
+static int lindenmayer_system_next_coord(struct lindenmayer_system* lsys, int* out_x, int* out_y)
+{
+	if (lsys->state >= 2) return 0;
+	if (lsys->state == 0) {
+		// it's awkward to emit either the first or last point
+		if (out_x) *out_x = 0;
+		if (out_y) *out_y = 0;
+		lsys->stack_height = 1;
+		lsys->stack[0].rule_index = 0;
+		lsys->stack[0].pc = 0;
+		lsys->state = 1;
+		return 1;
+	}
+	assert(lsys->state == 1);
+	for (;;) {
+		if (lsys->stack_height == 0) {
+			lsys->state = 2;
+			return 0;
+		}
+		struct lindenmayer_system_stack_entry* e = &lsys->stack[lsys->stack_height-1];
+		assert(0 <= e->rule_index && e->rule_index < lsys->n_rules);
+		struct lindenmayer_system_rule* rule = &lsys->rules[e->rule_index];
+		if (e->pc >= rule->length) {
+			lsys->stack_height--;
+			if (lsys->stack_height > 0) {
+				lsys->stack[lsys->stack_height-1].pc++;
+			}
+			continue;
+		}
+		assert(e->pc < rule->length);
+		char op = rule->ops[e->pc];
+		int new_rule_index = -1;
+		int did_emit = 0;
+		switch (op) {
+		case '^': {
+			switch (lsys->direction) {
+			case 0: lsys->x++; break;
+			case 1: lsys->y++; break;
+			case 2: lsys->x--; break;
+			case 3: lsys->y--; break;
+			default: assert(!"bad state");
+			}
+			if (out_x) *out_x = lsys->x;
+			if (out_y) *out_y = lsys->y;
+			did_emit = 1;
+		}	break;
+		case '+': {
+			lsys->direction = (lsys->direction + 1) & 3;
+		}	break;
+		case '-': {
+			lsys->direction = (lsys->direction + 3) & 3;
+		}	break;
+		default: {
+			assert('0' <= op && op <= '9');
+			new_rule_index = op - '0';
+		}	break;
+		}
+		if (new_rule_index >= 0 && lsys->stack_height < lsys->depth) {
+			assert(lsys->stack_height < ARRAY_LENGTH(lsys->stack));
+			lsys->stack[lsys->stack_height].rule_index = new_rule_index;
+			lsys->stack[lsys->stack_height].pc = 0;
+			lsys->stack_height++;
+		} else {
+			assert(lsys->stack_height > 0);
+			lsys->stack[lsys->stack_height-1].pc++;
+		}
+		if (did_emit) return 1;
+	}
+}
+
+static void input_set_error(struct uncurl_input_set* set, const char* path, const char* what)
+{
+	snprintf(set->error, sizeof set->error, "%s: %s", path, what);
+}
+
+static int input_set_add(struct uncurl_input_set* set, const char* path, size_t size)
+{
+	if (size == 0) return 1; // would make the offset index ambiguous
+	if (set->n_files >= set->cap) {
+		const int cap = set->cap ? set->cap*2 : 64;
+		struct uncurl_input_file* files = realloc(set->files, cap * sizeof set->files[0]);
+		if (files == NULL) {
+			input_set_error(set, path, "out of memory");
+			return 0;
+		}
+		set->files = files;
+		set->cap = cap;
+	}
+	char* dup = strdup(path);
+	if (dup == NULL) {
+		input_set_error(set, path, "out of memory");
+		return 0;
+	}
+	struct uncurl_input_file* f = &set->files[set->n_files++];
+	f->path = dup;
+	f->size = size;
+	f->fd = -1;
+	return 1;
+}
+
+static int input_set_add_path(struct uncurl_input_set* set, const char* path, int recurse)
+{
+	struct stat st;
+	if (stat(path, &st) == -1) {
+		input_set_error(set, path, "could not stat");
+		return 0;
+	}
+	if (S_ISREG(st.st_mode)) return input_set_add(set, path, st.st_size);
+	if (!recurse || !S_ISDIR(st.st_mode)) return 1;
+	DIR* dir = opendir(path);
+	if (dir == NULL) {
+		input_set_error(set, path, "could not open directory");
+		return 0;
+	}
+	struct dirent* de;
+	while ((de = readdir(dir)) != NULL) {
+		if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) continue;
+		char sub[1<<12];
+		snprintf(sub, sizeof sub, "%s/%s", path, de->d_name);
+		// don't follow symlinked directories; they can loop
+		struct stat lst;
+		if (lstat(sub, &lst) == -1) continue;
+		if (!input_set_add_path(set, sub, !S_ISLNK(lst.st_mode))) {
+			closedir(dir);
+			return 0;
+		}
+	}
+	closedir(dir);
+	return 1;
+}
+
+static int input_file_compar(const void* va, const void* vb)
+{
+	const struct uncurl_input_file* a = va;
+	const struct uncurl_input_file* b = vb;
+	return strcmp(a->path, b->path);
+}
+
+int uncurl_input_set_expand(struct uncurl_input_set* set, const char* arg)
+{
+	memset(set, 0, sizeof *set);
+	struct stat st;
+	if (arg[0] == '@') {
+		const char* tail = arg+1;
+		FILE* list = strcmp(tail, "-") == 0 ? stdin : fopen(tail, "r");
+		if (list == NULL) {
+			input_set_error(set, tail, "could not open list");
+			return -1;
+		}
+		char line[1<<12];
+		while (fgets(line, sizeof line, list) != NULL) {
+			size_t n = strlen(line);
+			while (n > 0 && (line[n-1] == '\n' || line[n-1] == '\r')) line[--n] = 0;
+			if (n == 0) continue;
+			if (!input_set_add_path(set, line, 1)) {
+				if (list != stdin) fclose(list);
+				return -1;
+			}
+		}
+		if (list != stdin) fclose(list);
+		// keep list order; it's what the user asked for
+	} else if (stat(arg, &st) == 0 && S_ISDIR(st.st_mode)) {
+		if (!input_set_add_path(set, arg, 1)) return -1;
+		qsort(set->files, set->n_files, sizeof set->files[0], input_file_compar);
+	} else if (strpbrk(arg, "*?[") != NULL && stat(arg, &st) == -1) {
+		glob_t g;
+		if (glob(arg, 0, NULL, &g) != 0) {
+			input_set_error(set, arg, "no matches");
+			return -1;
+		}
+		int ok = 1;
+		for (size_t i = 0; ok && i < g.gl_pathc; i++) ok = input_set_add_path(set, g.gl_pathv[i], 1);
+		globfree(&g);
+		if (!ok) return -1;
+	} else {
+		return 0;
+	}
+	if (set->n_files == 0) {
+		input_set_error(set, arg, "no (non-empty) files");
+		return -1;
+	}
+	size_t offset = 0;
+	for (int i = 0; i < set->n_files; i++) {
+		struct uncurl_input_file* f = &set->files[i];
+		f->offset = offset;
+		offset += f->size + (N_COMP - f->size % N_COMP) % N_COMP;
+	}
+	set->total_size = offset;
+	return 1;
+}
+
+int uncurl_input_set_find(const struct uncurl_input_set* set, size_t offset)
+{
+	int lo = 0, hi = set->n_files;
+	while (hi - lo > 1) {
+		const int mid = (lo + hi) >> 1;
+		if (set->files[mid].offset <= offset) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+struct input_set_reader {
+	struct uncurl_input_set* set;
+	uint8_t* data;
+	atomic_int is_short; // the first short file gets to describe itself
+};
+
+static void input_set_read_file(void* usr, int i)
+{
+	struct input_set_reader* rd = usr;
+	struct uncurl_input_file* f = &rd->set->files[i];
+	const int fd = open(f->path, O_RDONLY);
+	size_t n = 0;
+	if (fd != -1) {
+		while (n < f->size) {
+			const ssize_t r = pread(fd, rd->data + f->offset + n, f->size - n, n);
+			if (r <= 0) break;
+			n += r;
+		}
+		close(fd);
+	}
+	if (n < f->size && atomic_exchange(&rd->is_short, 1) == 0) {
+		char what[1<<7];
+		snprintf(what, sizeof what, "short read (%zu of %zu bytes)", n, f->size);
+		input_set_error(rd->set, f->path, what);
+	}
+}
+
+// several files are read at a time
+uint8_t* uncurl_input_set_read(struct uncurl_input_set* set)
+{
+	struct input_set_reader rd = {
+		.set = set,
+		.data = calloc(set->total_size, 1),
+	};
+	if (rd.data == NULL) {
+		snprintf(set->error, sizeof set->error, "out of memory (%zu bytes)", set->total_size);
+		return NULL;
+	}
+	uncurl_parallel_for(set->n_files, input_set_read_file, &rd);
+	if (atomic_load(&rd.is_short)) {
+		free(rd.data);
+		return NULL;
+	}
+	return rd.data;
+}
+
+// Hilbert curve kernels. they produce the same curve as the L-system rules
+// in uncurl_permutation_new() (same orientation and start point), but walk it top
+// down as a state machine, 4 levels (one byte of d, one nibble of x and y)
+// per table lookup. a state is the symmetry applied to the current
+// sub-square: bit 0 swaps x/y, bits 1 and 2 invert x and y.
+static uint8_t hilbert_d2xy_level[8][4];  // x bit, y bit<<1, next state<<2
+static uint8_t hilbert_xy2d_level[8][4];  // indexed by x bit|y bit<<1: digit, next state<<2
+static uint16_t hilbert_d2xy_table[8][256]; // x nibble, y nibble<<4, next state<<8
+static uint16_t hilbert_xy2d_table[8][256]; // indexed by x nibble|y nibble<<4: d byte, next state<<8
+static uint16_t hilbert_tile_table[8][1<<12]; // 64x64 tile for a 12-bit d: x, y<<6
+static pthread_once_t hilbert_tables_once = PTHREAD_ONCE_INIT;
+
+static inline int hilbert_walk(int s, int level, uint64_t v, uint32_t* out_x, uint32_t* out_y);
+
+static int hilbert_state_compose(int a, int b)
+{
+	int ix = (b>>1)&1, iy = (b>>2)&1;
+	if (a&1) {
+		const int t = ix;
+		ix = iy;
+		iy = t;
+	}
+	ix ^= (a>>1)&1;
+	iy ^= (a>>2)&1;
+	return ((a^b)&1) | (ix<<1) | (iy<<2);
+}
+
+static void hilbert_tables_init(void)
+{
+	// quadrant visited for each digit, and the sub-curve's symmetry
+	const int quadrant_x[4] = {0,0,1,1};
+	const int quadrant_y[4] = {0,1,1,0};
+	const int child[4] = {1, 0, 0, 1|2|4};
+	for (int state = 0; state < 8; state++) {
+		for (int q = 0; q < 4; q++) {
+			int x = quadrant_x[q], y = quadrant_y[q];
+			if (state&1) {
+				const int t = x;
+				x = y;
+				y = t;
+			}
+			x ^= (state>>1)&1;
+			y ^= (state>>2)&1;
+			const int next = hilbert_state_compose(state, child[q]);
+			hilbert_d2xy_level[state][q] = x | (y<<1) | (next<<2);
+			hilbert_xy2d_level[state][x | (y<<1)] = q | (next<<2);
+		}
+	}
+	for (int state = 0; state < 8; state++) {
+		for (int i = 0; i < 256; i++) {
+			int s = state, x = 0, y = 0;
+			for (int k = 3; k >= 0; k--) {
+				const int e = hilbert_d2xy_level[s][(i>>(2*k))&3];
+				x = (x<<1) | (e&1);
+				y = (y<<1) | ((e>>1)&1);
+				s = e>>2;
+			}
+			hilbert_d2xy_table[state][i] = x | (y<<4) | (s<<8);
+
+			s = state;
+			int d = 0;
+			for (int k = 3; k >= 0; k--) {
+				const int e = hilbert_xy2d_level[s][((i>>k)&1) | (((i>>(4+k))&1)<<1)];
+				d = (d<<2) | (e&3);
+				s = e>>2;
+			}
+			hilbert_xy2d_table[state][i] = d | (s<<8);
+		}
+	}
+	for (int state = 0; state < 8; state++) {
+		for (int i = 0; i < (1<<12); i++) {
+			uint32_t x, y;
+			hilbert_walk(state, 6, i, &x, &y);
+			hilbert_tile_table[state][i] = x | (y<<6);
+		}
+	}
+}
+
+// walks level levels down from state s, taking 2 bits of v per level;
+// returns the state at the bottom
+static inline int hilbert_walk(int s, int level, uint64_t v, uint32_t* out_x, uint32_t* out_y)
+{
+	uint32_t x = 0, y = 0;
+	while (level & 3) {
+		level--;
+		const int e = hilbert_d2xy_level[s][(v >> (2*level)) & 3];
+		x = (x<<1) | (e&1);
+		y = (y<<1) | ((e>>1)&1);
+		s = e>>2;
+	}
+	while (level > 0) {
+		level -= 4;
+		const int e = hilbert_d2xy_table[s][(v >> (2*level)) & 0xff];
+		x = (x<<4) | (e&0xf);
+		y = (y<<4) | ((e>>4)&0xf);
+		s = e>>8;
+	}
+	*out_x = x;
+	*out_y = y;
+	return s;
+}
+
+static void hilbert_d2xy_run(int width_log2, int n, const uint64_t* restrict d, uint32_t* restrict out_x, uint32_t* restrict out_y)
+{
+	pthread_once(&hilbert_tables_once, hilbert_tables_init);
+	for (int i = 0; i < n; i++) hilbert_walk(0, width_log2, d[i], &out_x[i], &out_y[i]);
+}
+
+static void hilbert_xy2d_run(int width_log2, int n, const uint32_t* restrict in_x, const uint32_t* restrict in_y, uint64_t* restrict out_d)
+{
+	pthread_once(&hilbert_tables_once, hilbert_tables_init);
+	const int lead = width_log2 & 3;
+	for (int i = 0; i < n; i++) {
+		const uint32_t x = in_x[i], y = in_y[i];
+		uint64_t d = 0;
+		int s = 0, level = width_log2;
+		for (int k = 0; k < lead; k++) {
+			level--;
+			const int e = hilbert_xy2d_level[s][((x>>level)&1) | (((y>>level)&1)<<1)];
+			d = (d<<2) | (e&3);
+			s = e>>2;
+		}
+		while (level > 0) {
+			level -= 4;
+			const int e = hilbert_xy2d_table[s][((x>>level)&0xf) | (((y>>level)&0xf)<<4)];
+			d = (d<<8) | (e&0xff);
+			s = e>>8;
+		}
+		out_d[i] = d;
+	}
+}
+
+#define KERNEL_CHUNK (1<<16) // points per parallel_for() job
+
+struct kernel_job {
+	int width_log2;
+	size_t n;
+	const uint64_t* d;
+	const uint32_t* x;
+	const uint32_t* y;
+	uint32_t* out_x;
+	uint32_t* out_y;
+	uint64_t* out_d;
+};
+
+static void d2xy_job(void* usr, int job)
+{
+	struct kernel_job* kj = usr;
+	const size_t i0 = (size_t)job * KERNEL_CHUNK;
+	const int n = kj->n - i0 < KERNEL_CHUNK ? kj->n - i0 : KERNEL_CHUNK;
+	hilbert_d2xy_run(kj->width_log2, n, kj->d + i0, kj->out_x + i0, kj->out_y + i0);
+}
+
+static void xy2d_job(void* usr, int job)
+{
+	struct kernel_job* kj = usr;
+	const size_t i0 = (size_t)job * KERNEL_CHUNK;
+	const int n = kj->n - i0 < KERNEL_CHUNK ? kj->n - i0 : KERNEL_CHUNK;
+	hilbert_xy2d_run(kj->width_log2, n, kj->x + i0, kj->y + i0, kj->out_d + i0);
+}
+
+void uncurl_d2xy(int width_log2, size_t n, const uint64_t* d, uint32_t* out_x, uint32_t* out_y)
+{
+	struct kernel_job kj = { .width_log2 = width_log2, .n = n, .d = d, .out_x = out_x, .out_y = out_y };
+	if (n <= KERNEL_CHUNK) {
+		hilbert_d2xy_run(width_log2, n, d, out_x, out_y);
+	} else {
+		uncurl_parallel_for((n + KERNEL_CHUNK - 1) / KERNEL_CHUNK, d2xy_job, &kj);
+	}
+}
+
+void uncurl_xy2d(int width_log2, size_t n, const uint32_t* x, const uint32_t* y, uint64_t* out_d)
+{
+	struct kernel_job kj = { .width_log2 = width_log2, .n = n, .x = x, .y = y, .out_d = out_d };
+	if (n <= KERNEL_CHUNK) {
+		hilbert_xy2d_run(width_log2, n, x, y, out_d);
+	} else {
+		uncurl_parallel_for((n + KERNEL_CHUNK - 1) / KERNEL_CHUNK, xy2d_job, &kj);
+	}
+}
+
+// figure out an image size that fits all the data; basically
+// 1<<ceil(log2(sqrt(n))) but without floating point math
+int uncurl_width_log2_for_length(size_t input_length)
+{
+	int width_log2 = 0;
+	while (((size_t)1 << (2*width_log2)) < input_length) width_log2++;
+	return width_log2;
+}
+
+int32_t* uncurl_permutation_new(enum uncurl_curve_type curve_type, int width_log2, size_t input_length)
+{
+	// int32 indices
+	if (width_log2 < 0 || width_log2 > 15) return NULL;
+	const int width = 1<<width_log2;
+	const size_t n_pixels = (size_t)1<<(2*width_log2);
+	int32_t* reverse = malloc(n_pixels * sizeof reverse[0]);
+	if (reverse == NULL) return NULL;
+	memset(reverse, -1, n_pixels*sizeof(reverse[0]));
+
+	if (curve_type == UNCURL_CURVE_TYPE_hilbert) {
+		uint32_t* xs = malloc(width * sizeof xs[0]);
+		uint32_t* ys = malloc(width * sizeof ys[0]);
+		uint64_t* ds = malloc(width * sizeof ds[0]);
+		if (xs == NULL || ys == NULL || ds == NULL) {
+			free(xs);
+			free(ys);
+			free(ds);
+			free(reverse);
+			return NULL;
+		}
+		for (int x = 0; x < width; x++) xs[x] = x;
+		for (int y = 0; y < width; y++) {
+			for (int x = 0; x < width; x++) ys[x] = y;
+			hilbert_xy2d_run(width_log2, width, xs, ys, ds);
+			int32_t* row = &reverse[y << width_log2];
+			for (int x = 0; x < width; x++) row[x] = ds[x] < input_length ? (int)ds[x] : -1;
+		}
+		free(xs);
+		free(ys);
+		free(ds);
+		return reverse;
+	}
+
+	// generic (and slow) path for curves without kernels
+	struct lindenmayer_system lsys;
+	switch (curve_type) {
+	case UNCURL_CURVE_TYPE_hilbert: {
+		const char* rules[] = {
+			"+1^-0^0-^1+",
+			"-0^+1^1+^0-",
+		};
+		lindenmayer_system_init(&lsys, ARRAY_LENGTH(rules), rules, width_log2);
+	}	break;
+	default:
+		free(reverse);
+		return NULL;
+	}
+
+	int px, py;
+	int32_t point_index = 0;
+	while (point_index < input_length && lindenmayer_system_next_coord(&lsys, &px, &py)) {
+		assert(0 <= px && px < width);
+		assert(0 <= py && py < width);
+		const int image_index = (py << width_log2) + px;
+		assert(0 <= image_index && image_index < n_pixels);
+		reverse[image_index] = point_index++;
+	}
+	return reverse;
+}
+
+#define FILL_CHUNK (1<<18) // pixels per parallel_for() job
+
+struct fill_job {
+	uint8_t* image;
+	const int32_t* reverse;
+	int n_pixels;
+	const uint8_t* data;
+};
+
+static void fill_chunk(void* usr, int chunk)
+{
+	const struct fill_job* fj = usr;
+	const int i0 = chunk * FILL_CHUNK;
+	const int i1 = fj->n_pixels - i0 < FILL_CHUNK ? fj->n_pixels : i0 + FILL_CHUNK;
+	uint8_t* wp = &fj->image[(size_t)i0*N_COMP];
+	for (int i = i0; i < i1; i++) {
+		const int p = fj->reverse[i];
+		if (p >= 0) {
+			const uint8_t* rp = &fj->data[(size_t)p*N_COMP];
+			for (int c=0; c<N_COMP; c++) *(wp++) = *(rp++);
+		} else {
+			for (int c=0; c<N_COMP; c++) *(wp++) = 0;
+		}
+	}
+}
+
+// "curls" data into image by gathering along the permutation, in chunks of
+// pixels; writes are sequential so this runs at about memory speed
+void uncurl_fill(uint8_t* image, const int32_t* reverse, int n_pixels, const uint8_t* data)
+{
+	struct fill_job fj = {
+		.image = image,
+		.reverse = reverse,
+		.n_pixels = n_pixels,
+		.data = data,
+	};
+	if (n_pixels > 0) uncurl_parallel_for((n_pixels + FILL_CHUNK - 1) / FILL_CHUNK, fill_chunk, &fj);
+}
+
+
+#define RASTER_TILE_LOG2 (6) // aligned blocks of 4096 points cover aligned 64x64 tiles
+
+struct raster_job {
+	const uint8_t* data;
+	size_t n_points;
+	int width_log2;
+	uint8_t* image;
+	size_t stride;
+	int bytes_per_pixel; // and per point, when rasterizing
+	uint64_t d0;
+	uint8_t* out;
+	uint32_t y0; // first image row (uncurl_rasterize_rows())
+};
+
+// d2xy for all 4096 points of an aligned block; walks down to the tile once,
+// then it's a table lookup per point
+static void hilbert_tile_d2xy(int width_log2, uint64_t tile_index, uint32_t* xs, uint32_t* ys)
+{
+	pthread_once(&hilbert_tables_once, hilbert_tables_init);
+	uint32_t tx, ty;
+	const int s = hilbert_walk(0, width_log2 - RASTER_TILE_LOG2, tile_index, &tx, &ty);
+	const uint16_t* tile = hilbert_tile_table[s];
+	for (int i = 0; i < (1 << (2*RASTER_TILE_LOG2)); i++) {
+		xs[i] = (tx << RASTER_TILE_LOG2) + (tile[i] & 63);
+		ys[i] = (ty << RASTER_TILE_LOG2) + (tile[i] >> 6);
+	}
+}
+
+static int raster_block_log2(int width_log2)
+{
+	return (2*width_log2) < (2*RASTER_TILE_LOG2) ? (2*width_log2) : (2*RASTER_TILE_LOG2);
+}
+
+static void rasterize_block(void* usr, int block)
+{
+	struct raster_job* rj = usr;
+	const int block_log2 = raster_block_log2(rj->width_log2);
+	const int n = 1 << block_log2;
+	uint64_t ds[1 << (2*RASTER_TILE_LOG2)];
+	uint32_t xs[1 << (2*RASTER_TILE_LOG2)];
+	uint32_t ys[1 << (2*RASTER_TILE_LOG2)];
+	const uint64_t d0 = (uint64_t)block << block_log2;
+	if (block_log2 == 2*RASTER_TILE_LOG2 && d0 + n <= rj->n_points) {
+		// whole tiles are scattered into a packed copy first: image rows
+		// are often a multiple of 4k apart, and then every row of the tile
+		// falls in the same cache sets
+		pthread_once(&hilbert_tables_once, hilbert_tables_init);
+		uint32_t tx, ty;
+		const int s = hilbert_walk(0, rj->width_log2 - RASTER_TILE_LOG2, block, &tx, &ty);
+		const uint16_t* tile = hilbert_tile_table[s];
+		const int bpp = rj->bytes_per_pixel;
+		const uint8_t* src = rj->data + d0*bpp;
+		uint8_t packed[(1 << (2*RASTER_TILE_LOG2)) * N_COMP];
+		if (bpp == 1) {
+			for (int i = 0; i < n; i++) packed[tile[i]] = src[i];
+		} else {
+			for (int i = 0; i < n; i++) memcpy(packed + tile[i]*N_COMP, src + i*N_COMP, N_COMP);
+		}
+		const size_t row_size = (size_t)bpp << RASTER_TILE_LOG2;
+		uint8_t* wp = rj->image + ((ty << RASTER_TILE_LOG2) - rj->y0)*rj->stride + tx*row_size;
+		for (int y = 0; y < (1 << RASTER_TILE_LOG2); y++) memcpy(wp + y*rj->stride, packed + y*row_size, row_size);
+		return;
+	}
+	if (block_log2 == 2*RASTER_TILE_LOG2) {
+		hilbert_tile_d2xy(rj->width_log2, block, xs, ys);
+	} else {
+		for (int i = 0; i < n; i++) ds[i] = d0 + i;
+		hilbert_d2xy_run(rj->width_log2, n, ds, xs, ys);
+	}
+	if (rj->bytes_per_pixel == 1) {
+		for (int i = 0; i < n; i++) {
+			rj->image[(ys[i] - rj->y0)*rj->stride + xs[i]] = d0 + i < rj->n_points ? rj->data[d0 + i] : 0;
+		}
+		return;
+	}
+	for (int i = 0; i < n; i++) {
+		uint8_t* wp = rj->image + (ys[i] - rj->y0)*rj->stride + (size_t)xs[i]*N_COMP;
+		if (d0 + i < rj->n_points) {
+			memcpy(wp, &rj->data[(d0 + i)*N_COMP], N_COMP);
+		} else {
+			memset(wp, 0, N_COMP);
+		}
+	}
+}
+
+static void rasterize(const uint8_t* data, size_t n_points, int width_log2, uint8_t* image, size_t stride, int bytes_per_pixel)
+{
+	struct raster_job rj = { .data = data, .n_points = n_points, .width_log2 = width_log2, .image = image, .stride = stride, .bytes_per_pixel = bytes_per_pixel };
+	uncurl_parallel_for(1 << (2*width_log2 - raster_block_log2(width_log2)), rasterize_block, &rj);
+}
+
+void uncurl_rasterize(const uint8_t* data, size_t n_points, int width_log2, uint8_t* image, size_t stride)
+{
+	rasterize(data, n_points, width_log2, image, stride, N_COMP);
+}
+
+void uncurl_rasterize_index(const uint8_t* data, size_t n_points, int width_log2, uint8_t* image, size_t stride)
+{
+	rasterize(data, n_points, width_log2, image, stride, 1);
+}
+
+// one tile of a band of rows; tiles are numbered row by row
+static void rasterize_band_tile(void* usr, int tile)
+{
+	struct raster_job* rj = usr;
+	const int tiles_log2 = rj->width_log2 - RASTER_TILE_LOG2;
+	const uint32_t tx = tile & ((1 << tiles_log2) - 1);
+	const uint32_t ty = (rj->y0 >> RASTER_TILE_LOG2) + (tile >> tiles_log2);
+	// the curve of tiles is the curve at a coarser width
+	uint64_t block;
+	hilbert_xy2d_run(tiles_log2, 1, &tx, &ty, &block);
+	rasterize_block(usr, block);
+}
+
+void uncurl_rasterize_rows(const uint8_t* data, size_t n_points, int width_log2, uint32_t y0, uint32_t n_rows, uint8_t* image, size_t stride)
+{
+	if (width_log2 < RASTER_TILE_LOG2) {
+		assert(y0 == 0 && n_rows == (1u << width_log2));
+		uncurl_rasterize(data, n_points, width_log2, image, stride);
+		return;
+	}
+	assert((1 << RASTER_TILE_LOG2) == UNCURL_BAND_ROWS);
+	assert((y0 % UNCURL_BAND_ROWS) == 0 && (n_rows % UNCURL_BAND_ROWS) == 0);
+	assert(y0 + n_rows <= (1u << width_log2));
+	struct raster_job rj = { .data = data, .n_points = n_points, .width_log2 = width_log2, .image = image, .stride = stride, .bytes_per_pixel = N_COMP, .y0 = y0 };
+	uncurl_parallel_for((n_rows >> RASTER_TILE_LOG2) << (width_log2 - RASTER_TILE_LOG2), rasterize_band_tile, &rj);
+}
+
+static void flatten_block(void* usr, int block)
+{
+	struct raster_job* rj = usr;
+	const size_t block_size = 1 << (2*RASTER_TILE_LOG2);
+	const size_t i0 = (size_t)block * block_size;
+	const size_t n = rj->n_points - i0 < block_size ? rj->n_points - i0 : block_size;
+	uint64_t ds[1 << (2*RASTER_TILE_LOG2)];
+	uint32_t xs[1 << (2*RASTER_TILE_LOG2)];
+	uint32_t ys[1 << (2*RASTER_TILE_LOG2)];
+	const uint64_t d0 = rj->d0 + i0;
+	if (n == block_size && (d0 & (block_size-1)) == 0 && rj->width_log2 >= RASTER_TILE_LOG2) {
+		hilbert_tile_d2xy(rj->width_log2, d0 >> (2*RASTER_TILE_LOG2), xs, ys);
+	} else {
+		for (size_t i = 0; i < block_size; i++) ds[i] = d0 + i;
+		hilbert_d2xy_run(rj->width_log2, n, ds, xs, ys);
+	}
+	// the block touches at most two 64x64 tiles, so the reads stay in cache
+	uint8_t* wp = rj->out + i0*N_COMP;
+	for (size_t i = 0; i < n; i++) {
+		const uint8_t* rp = rj->image + ys[i]*rj->stride + (size_t)xs[i]*rj->bytes_per_pixel;
+		for (int c=0; c<N_COMP; c++) *(wp++) = *(rp++);
+	}
+}
+
+void uncurl_flatten(const uint8_t* image, int width_log2, size_t stride, int bytes_per_pixel, uint64_t d0, size_t n_points, uint8_t* out)
+{
+	assert(bytes_per_pixel >= N_COMP);
+	struct raster_job rj = {
+		.n_points = n_points,
+		.width_log2 = width_log2,
+		.image = (uint8_t*)image,
+		.stride = stride,
+		.bytes_per_pixel = bytes_per_pixel,
+		.d0 = d0,
+		.out = out,
+	};
+	const size_t block_size = 1 << (2*RASTER_TILE_LOG2);
+	uncurl_parallel_for((n_points + block_size - 1) / block_size, flatten_block, &rj);
+}
+
+#define REDUCE_CHUNK (1<<12) // output points per parallel_for() job
+
+struct reduce_job {
+	const uint8_t* data;
+	size_t n_points;
+	int level;
+	uint8_t* out;
+};
+
+static void reduce_chunk(void* usr, int chunk)
+{
+	struct reduce_job* rj = usr;
+	const size_t block = (size_t)1 << (2*rj->level);
+	const size_t n_out = (rj->n_points + block - 1) / block;
+	const size_t i0 = (size_t)chunk * REDUCE_CHUNK;
+	const size_t i1 = n_out - i0 < REDUCE_CHUNK ? n_out : i0 + REDUCE_CHUNK;
+	for (size_t i = i0; i < i1; i++) {
+		const size_t p0 = i*block;
+		const size_t p1 = rj->n_points - p0 < block ? rj->n_points : p0 + block;
+		uint64_t sum[N_COMP] = {0};
+		const uint8_t* rp = &rj->data[p0*N_COMP];
+		for (size_t p = p0; p < p1; p++) {
+			for (int c=0; c<N_COMP; c++) sum[c] += *(rp++);
+		}
+		const uint64_t n = p1 - p0;
+		for (int c=0; c<N_COMP; c++) rj->out[i*N_COMP + c] = (sum[c] + n/2) / n;
+	}
+}
+
+void uncurl_reduce(const uint8_t* data, size_t n_points, int level, uint8_t* out)
+{
+	struct reduce_job rj = { .data = data, .n_points = n_points, .level = level, .out = out };
+	const size_t block = (size_t)1 << (2*level);
+	const size_t n_out = (n_points + block - 1) / block;
+	uncurl_parallel_for((n_out + REDUCE_CHUNK - 1) / REDUCE_CHUNK, reduce_chunk, &rj);
+}
+
+// interleaving: 16 points at a time, the channels are unpacked into RGB0
+// words (byte and word unpacks, which every SIMD target does well) and the
+// zero bytes squeezed out of pairs of them in 64-bit lanes. each pair is
+// stored as 8 bytes, 2 of which the next store overwrites, so the vector
+// loop stops a point short of the end of a job's range
+#define INTERLEAVE_CHUNK (1<<18) // points per parallel_for() job
+
+typedef uint8_t interleave_u8x16 __attribute__ ((vector_size (16)));
+typedef uint16_t interleave_u16x8 __attribute__ ((vector_size (16)));
+typedef uint64_t interleave_u64x2 __attribute__ ((vector_size (16)));
+
+struct interleave_job {
+	const uint8_t* const* channels;
+	const size_t* sizes;
+	size_t n_points;
+	uint8_t* out;
+};
+
+static void interleave_chunk(void* usr, int chunk)
+{
+	struct interleave_job* ij = usr;
+	const uint8_t* r = ij->channels[0];
+	const uint8_t* g = ij->channels[1];
+	const uint8_t* b = ij->channels[2];
+	const size_t i0 = (size_t)chunk * INTERLEAVE_CHUNK;
+	const size_t i1 = ij->n_points - i0 < INTERLEAVE_CHUNK ? ij->n_points : i0 + INTERLEAVE_CHUNK;
+	// where all three have data
+	size_t i_full = i1;
+	for (int c = 0; c < N_COMP; c++) {
+		if (ij->sizes[c] < i_full) i_full = ij->sizes[c];
+	}
+	const interleave_u8x16 zero = {0};
+	size_t i = i0;
+	#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	for (; i + 17 <= i_full; i += 16) {
+		interleave_u8x16 vr, vg, vb;
+		memcpy(&vr, r + i, sizeof vr);
+		memcpy(&vg, g + i, sizeof vg);
+		memcpy(&vb, b + i, sizeof vb);
+		const interleave_u16x8 rg_lo = (interleave_u16x8)__builtin_shufflevector(vr, vg, 0,16,1,17,2,18,3,19,4,20,5,21,6,22,7,23);
+		const interleave_u16x8 rg_hi = (interleave_u16x8)__builtin_shufflevector(vr, vg, 8,24,9,25,10,26,11,27,12,28,13,29,14,30,15,31);
+		const interleave_u16x8 b_lo = (interleave_u16x8)__builtin_shufflevector(vb, zero, 0,16,1,17,2,18,3,19,4,20,5,21,6,22,7,23);
+		const interleave_u16x8 b_hi = (interleave_u16x8)__builtin_shufflevector(vb, zero, 8,24,9,25,10,26,11,27,12,28,13,29,14,30,15,31);
+		const interleave_u64x2 words[4] = {
+			(interleave_u64x2)__builtin_shufflevector(rg_lo, b_lo, 0,8,1,9,2,10,3,11),
+			(interleave_u64x2)__builtin_shufflevector(rg_lo, b_lo, 4,12,5,13,6,14,7,15),
+			(interleave_u64x2)__builtin_shufflevector(rg_hi, b_hi, 0,8,1,9,2,10,3,11),
+			(interleave_u64x2)__builtin_shufflevector(rg_hi, b_hi, 4,12,5,13,6,14,7,15),
+		};
+		uint8_t* wp = ij->out + i*N_COMP;
+		for (int k = 0; k < 4; k++) {
+			// point 2j+1 moves down next to point 2j
+			const interleave_u64x2 pair = (words[k] & 0xffffff) | ((words[k] >> 8) & 0xffffff000000ull);
+			memcpy(wp, &pair[0], 8);
+			memcpy(wp + 6, &pair[1], 8);
+			wp += 12;
+		}
+	}
+	#endif
+	for (; i < i1; i++) {
+		for (int c = 0; c < N_COMP; c++) ij->out[i*N_COMP + c] = i < ij->sizes[c] ? ij->channels[c][i] : 0;
+	}
+}
+
+void uncurl_interleave(const uint8_t* const* channels, const size_t* sizes, size_t n_points, uint8_t* out)
+{
+	assert(N_COMP == 3);
+	struct interleave_job ij = { .channels = channels, .sizes = sizes, .n_points = n_points, .out = out };
+	uncurl_parallel_for((n_points + INTERLEAVE_CHUNK - 1) / INTERLEAVE_CHUNK, interleave_chunk, &ij);
+}
+
+// records are projected 8 bytes at a time: widened to two vectors of 4
+// floats and multiply-added into a pair of accumulators per channel, using
+// vectors the compiler maps onto whatever SIMD the target has (SSE2, NEON,
+// or plain scalar code). the lanes are added up at the end of each record
+#define PROJECT_CHUNK (1<<14) // records per parallel_for() job
+#define PROJECT_FIT_CHUNK (1<<10) // sampled records per job while fitting
+#define PROJECT_SAMPLE_BYTES (1<<22)
+#define PROJECT_MIN_SAMPLE (1<<12)
+#define PROJECT_ITERATIONS (8)
+
+typedef float project_f32x4 __attribute__ ((vector_size (16)));
+typedef int32_t project_i32x4 __attribute__ ((vector_size (16)));
+typedef uint16_t project_u16x8 __attribute__ ((vector_size (16)));
+typedef uint16_t project_u16x4 __attribute__ ((vector_size (8)));
+typedef uint8_t project_u8x8 __attribute__ ((vector_size (8)));
+
+// dot products of a record with the N_COMP rows of axes (stride floats
+// apart)
+static inline void project_record(const float* restrict axes, size_t stride, const uint8_t* restrict rp, int record_size, float* restrict out)
+{
+	assert((N_COMP == 3) && "unrolled for N_COMP==3");
+	// written out per channel so the sums stay in registers
+	project_f32x4 a0 = {0}, a1 = {0}, a2 = {0};
+	project_f32x4 b0 = {0}, b1 = {0}, b2 = {0};
+	const float* w0 = axes;
+	const float* w1 = axes + stride;
+	const float* w2 = axes + 2*stride;
+	int j = 0;
+	for (; j + 8 <= record_size; j += 8) {
+		project_u8x8 bytes;
+		memcpy(&bytes, &rp[j], sizeof bytes);
+		const project_u16x8 h = __builtin_convertvector(bytes, project_u16x8);
+		const project_u16x4 hx = __builtin_shufflevector(h, h, 0, 1, 2, 3);
+		const project_u16x4 hy = __builtin_shufflevector(h, h, 4, 5, 6, 7);
+		const project_f32x4 x = __builtin_convertvector(__builtin_convertvector(hx, project_i32x4), project_f32x4);
+		const project_f32x4 y = __builtin_convertvector(__builtin_convertvector(hy, project_i32x4), project_f32x4);
+		project_f32x4 w;
+		memcpy(&w, &w0[j], sizeof w); a0 += w * x;
+		memcpy(&w, &w1[j], sizeof w); a1 += w * x;
+		memcpy(&w, &w2[j], sizeof w); a2 += w * x;
+		memcpy(&w, &w0[j+4], sizeof w); b0 += w * y;
+		memcpy(&w, &w1[j+4], sizeof w); b1 += w * y;
+		memcpy(&w, &w2[j+4], sizeof w); b2 += w * y;
+	}
+	a0 += b0;
+	a1 += b1;
+	a2 += b2;
+	out[0] = (a0[0] + a0[1]) + (a0[2] + a0[3]);
+	out[1] = (a1[0] + a1[1]) + (a1[2] + a1[3]);
+	out[2] = (a2[0] + a2[1]) + (a2[2] + a2[3]);
+	for (; j < record_size; j++) {
+		const float x = rp[j];
+		out[0] += w0[j] * x;
+		out[1] += w1[j] * x;
+		out[2] += w2[j] * x;
+	}
+}
+
+struct project_job {
+	const struct uncurl_projection* proj;
+	const uint8_t* data;
+	size_t n_records;
+	uint8_t* out;
+};
+
+static void project_chunk(void* usr, int chunk)
+{
+	struct project_job* pj = usr;
+	const struct uncurl_projection* proj = pj->proj;
+	const size_t i0 = (size_t)chunk * PROJECT_CHUNK;
+	const size_t i1 = pj->n_records - i0 < PROJECT_CHUNK ? pj->n_records : i0 + PROJECT_CHUNK;
+	for (size_t i = i0; i < i1; i++) {
+		float v[N_COMP];
+		project_record(&proj->weights[0][0], UNCURL_RECORD_MAX, &pj->data[i*proj->record_size], proj->record_size, v);
+		for (int c = 0; c < N_COMP; c++) {
+			const float x = v[c] + proj->bias[c] + 0.5f;
+			pj->out[i*N_COMP + c] = x <= 0.0f ? 0 : x >= 255.0f ? 255 : (uint8_t)x;
+		}
+	}
+}
+
+void uncurl_project(const struct uncurl_projection* proj, const uint8_t* data, size_t n_records, uint8_t* out)
+{
+	struct project_job pj = { .proj = proj, .data = data, .n_records = n_records, .out = out };
+	uncurl_parallel_for((n_records + PROJECT_CHUNK - 1) / PROJECT_CHUNK, project_chunk, &pj);
+}
+
+// fitting runs on a sample of records spread evenly over the data. each job
+// sums over a chunk of it into its own slot of partial, which are added up
+// afterwards in a fixed order, so fits don't depend on scheduling
+enum {
+	FIT_MEAN,
+	FIT_ITERATE, // partial = sum of (x-mean) ((x-mean).axes)
+	FIT_MOMENTS, // partial = sum of (x-mean).axes and its square
+};
+
+struct fit_job {
+	int pass;
+	const uint8_t* data;
+	size_t n_records, n_sample;
+	int record_size;
+	const float* mean;
+	const float* axes; // N_COMP rows of UNCURL_RECORD_MAX
+	float axes_mean[N_COMP]; // axes.mean
+	double* partial; // per job
+	size_t partial_size;
+};
+
+static void fit_chunk(void* usr, int chunk)
+{
+	struct fit_job* fj = usr;
+	const int d = fj->record_size;
+	double* partial = &fj->partial[chunk * fj->partial_size];
+	memset(partial, 0, fj->partial_size * sizeof *partial);
+	float* acc = calloc(fj->partial_size, sizeof *acc);
+	assert(acc != NULL);
+	float shifted[UNCURL_RECORD_MAX];
+	const size_t s0 = (size_t)chunk * PROJECT_FIT_CHUNK;
+	const size_t s1 = fj->n_sample - s0 < PROJECT_FIT_CHUNK ? fj->n_sample : s0 + PROJECT_FIT_CHUNK;
+	for (size_t s = s0; s < s1; s++) {
+		const uint8_t* rp = &fj->data[(s * fj->n_records / fj->n_sample) * d];
+		if (fj->pass == FIT_MEAN) {
+			for (int j = 0; j < d; j++) acc[j] += rp[j];
+			continue;
+		}
+		float t[N_COMP];
+		project_record(fj->axes, UNCURL_RECORD_MAX, rp, d, t);
+		for (int c = 0; c < N_COMP; c++) t[c] -= fj->axes_mean[c];
+		if (fj->pass == FIT_MOMENTS) {
+			for (int c = 0; c < N_COMP; c++) {
+				acc[2*c] += t[c];
+				acc[2*c + 1] += t[c]*t[c];
+			}
+			continue;
+		}
+		for (int j = 0; j < d; j++) shifted[j] = (float)rp[j] - fj->mean[j];
+		for (int c = 0; c < N_COMP; c++) {
+			float* restrict wp = &acc[c*d];
+			const project_f32x4 tc = { t[c], t[c], t[c], t[c] };
+			int j = 0;
+			for (; j + 4 <= d; j += 4) {
+				project_f32x4 w, x;
+				memcpy(&w, &wp[j], sizeof w);
+				memcpy(&x, &shifted[j], sizeof x);
+				w += x * tc;
+				memcpy(&wp[j], &w, sizeof w);
+			}
+			for (; j < d; j++) wp[j] += shifted[j] * t[c];
+		}
+	}
+	for (size_t i = 0; i < fj->partial_size; i++) partial[i] = acc[i];
+	free(acc);
+}
+
+// runs a pass and sums its partials into out
+static void fit_pass(struct fit_job* fj, int pass, size_t partial_size, double* out)
+{
+	const int n_chunks = (fj->n_sample + PROJECT_FIT_CHUNK - 1) / PROJECT_FIT_CHUNK;
+	fj->pass = pass;
+	fj->partial_size = partial_size;
+	for (int c = 0; c < N_COMP; c++) {
+		fj->axes_mean[c] = 0.0f;
+		for (int j = 0; j < fj->record_size; j++) fj->axes_mean[c] += fj->axes[c*UNCURL_RECORD_MAX + j] * fj->mean[j];
+	}
+	fj->partial = malloc(n_chunks * partial_size * sizeof *fj->partial);
+	assert(fj->partial != NULL);
+	uncurl_parallel_for(n_chunks, fit_chunk, fj);
+	memset(out, 0, partial_size * sizeof *out);
+	for (int k = 0; k < n_chunks; k++) {
+		for (size_t i = 0; i < partial_size; i++) out[i] += fj->partial[k*partial_size + i];
+	}
+	free(fj->partial);
+	fj->partial = NULL;
+}
+
+// Gram-Schmidt on the rows; rows that are (numerically) in the span of the
+// ones before become zero, and stay that way
+static void orthonormalize(double* rows, int n_rows, int d)
+{
+	for (int c = 0; c < n_rows; c++) {
+		double* r = &rows[c*d];
+		for (int k = 0; k < c; k++) {
+			const double* q = &rows[k*d];
+			double dot = 0.0;
+			for (int j = 0; j < d; j++) dot += r[j]*q[j];
+			for (int j = 0; j < d; j++) r[j] -= dot*q[j];
+		}
+		double norm = 0.0;
+		for (int j = 0; j < d; j++) norm += r[j]*r[j];
+		norm = sqrt(norm);
+		for (int j = 0; j < d; j++) r[j] = norm > 1e-9 ? r[j]/norm : 0.0;
+	}
+}
+
+void uncurl_projection_fit(struct uncurl_projection* proj, enum uncurl_projection_type type, const uint8_t* data, size_t n_records, int record_size)
+{
+	assert(1 <= record_size && record_size <= UNCURL_RECORD_MAX);
+	const int d = record_size;
+	memset(proj, 0, sizeof *proj);
+	proj->record_size = d;
+	for (int c = 0; c < N_COMP; c++) proj->bias[c] = 127.5f;
+	if (n_records == 0) return;
+
+	size_t n_sample = PROJECT_SAMPLE_BYTES / d;
+	if (n_sample < PROJECT_MIN_SAMPLE) n_sample = PROJECT_MIN_SAMPLE;
+	if (n_sample > n_records) n_sample = n_records;
+	float* mean = calloc(d, sizeof *mean);
+	float (*axes)[UNCURL_RECORD_MAX] = calloc(N_COMP, sizeof *axes);
+	double* sums = calloc(N_COMP*d, sizeof *sums);
+	assert(mean != NULL && axes != NULL && sums != NULL);
+	struct fit_job fj = {
+		.data = data,
+		.n_records = n_records,
+		.n_sample = n_sample,
+		.record_size = d,
+		.mean = mean,
+		.axes = &axes[0][0],
+	};
+
+	fit_pass(&fj, FIT_MEAN, d, sums);
+	for (int j = 0; j < d; j++) mean[j] = sums[j] / n_sample;
+
+	// random directions to start from (or to keep); a fixed seed, so the
+	// same data always gets the same colors
+	uint64_t rng = 0x9e3779b97f4a7c15ull;
+	for (int i = 0; i < N_COMP*d; i++) {
+		rng ^= rng << 13;
+		rng ^= rng >> 7;
+		rng ^= rng << 17;
+		sums[i] = (double)(rng >> 11) / (double)(1ull << 53) - 0.5;
+	}
+	// block power iteration: axes converge on the top eigenvectors of the
+	// sample's covariance without ever forming the d*d matrix
+	const int n_iterations = type == UNCURL_PROJECTION_PCA ? PROJECT_ITERATIONS : 0;
+	for (int it = 0; ; it++) {
+		orthonormalize(sums, N_COMP, d);
+		for (int c = 0; c < N_COMP; c++) {
+			for (int j = 0; j < d; j++) axes[c][j] = sums[c*d + j];
+		}
+		if (it == n_iterations) break;
+		fit_pass(&fj, FIT_ITERATE, N_COMP*d, sums);
+	}
+
+	// signs are arbitrary; pick the ones that make bigger bytes brighter
+	for (int c = 0; c < N_COMP; c++) {
+		float sum = 0.0f;
+		for (int j = 0; j < d; j++) sum += axes[c][j];
+		if (sum < 0.0f) {
+			for (int j = 0; j < d; j++) axes[c][j] = -axes[c][j];
+		}
+	}
+
+	double moments[2*N_COMP];
+	fit_pass(&fj, FIT_MOMENTS, 2*N_COMP, moments);
+	for (int c = 0; c < N_COMP; c++) {
+		const double m = moments[2*c] / n_sample;
+		const double var = moments[2*c + 1] / n_sample - m*m;
+		const float s = var > 1e-12 ? 255.0 / (4.0*sqrt(var)) : 0.0;
+		float offset = 0.0f;
+		for (int j = 0; j < d; j++) {
+			proj->weights[c][j] = s * axes[c][j];
+			offset += axes[c][j] * mean[j];
+		}
+		proj->bias[c] = 127.5f - s*(offset + m);
+	}
+	free(mean);
+	free(axes);
+	free(sums);
+}
+
+// compressibility: blocks are run through the greedy parse LZ4 does (4-byte
+// hashes, one candidate each, skipping ahead faster the longer nothing
+// matches), but only the size of what would be written is counted. blocks
+// are independent, so chunks of them go to the pool
+#define COMPRESS_CHUNK (1<<22) // bytes per parallel_for() job, about
+#define COMPRESS_HASH_LOG2 (12)
+#define COMPRESS_MIN_MATCH (4)
+
+struct compress_job {
+	const uint8_t* data;
+	size_t size, block_size, blocks_per_job;
+	uint8_t* out;
+};
+
+static inline uint32_t compress_load32(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof v);
+	return v;
+}
+
+static inline uint64_t compress_load64(const uint8_t* p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof v);
+	return v;
+}
+
+// bytes of a length that doesn't fit its 4 bits in the token
+static inline size_t compress_length_bytes(size_t n)
+{
+	return n >= 15 ? (n - 15) / 255 + 1 : 0;
+}
+
+// what LZ4's block format would take for p[0;n), n <= 1<<16
+static size_t compress_block_size(const uint8_t* p, size_t n, uint16_t* table)
+{
+	memset(table, 0, sizeof(uint16_t) << COMPRESS_HASH_LOG2);
+	size_t i = 0, anchor = 0, out = 0;
+	while (i + COMPRESS_MIN_MATCH <= n) {
+		const uint32_t seq = compress_load32(p + i);
+		const uint32_t h = (seq * 2654435761u) >> (32 - COMPRESS_HASH_LOG2);
+		const size_t ref = table[h];
+		table[h] = i;
+		if (ref >= i || compress_load32(p + ref) != seq) {
+			i += 1 + ((i - anchor) >> 6);
+			continue;
+		}
+		size_t len = COMPRESS_MIN_MATCH;
+		while (i + len + 8 <= n) {
+			const uint64_t x = compress_load64(p + ref + len) ^ compress_load64(p + i + len);
+			if (x != 0) {
+				len += __builtin_ctzll(x) >> 3; // little endian
+				goto matched;
+			}
+			len += 8;
+		}
+		while (i + len < n && p[ref + len] == p[i + len]) len++;
+	matched:;
+		const size_t n_literals = i - anchor;
+		out += 1 + n_literals + compress_length_bytes(n_literals) + 2 + compress_length_bytes(len - COMPRESS_MIN_MATCH);
+		i += len;
+		anchor = i;
+	}
+	const size_t n_literals = n - anchor;
+	return out + 1 + n_literals + compress_length_bytes(n_literals);
+}
+
+static void compress_chunk(void* usr, int chunk)
+{
+	struct compress_job* cj = usr;
+	uint16_t table[1 << COMPRESS_HASH_LOG2];
+	const size_t n_blocks = (cj->size + cj->block_size - 1) / cj->block_size;
+	const size_t b0 = (size_t)chunk * cj->blocks_per_job;
+	const size_t b1 = n_blocks - b0 < cj->blocks_per_job ? n_blocks : b0 + cj->blocks_per_job;
+	for (size_t b = b0; b < b1; b++) {
+		const size_t offset = b * cj->block_size;
+		const size_t n = cj->size - offset < cj->block_size ? cj->size - offset : cj->block_size;
+		const size_t c = compress_block_size(cj->data + offset, n, table);
+		cj->out[b] = 1 + (254 * (c < n ? c : n)) / n;
+	}
+}
+
+int uncurl_compressibility(const uint8_t* data, size_t size, size_t block_size, uint8_t* out)
+{
+	if (block_size < 1 || block_size > UNCURL_COMPRESS_BLOCK_MAX) return -1;
+	struct compress_job cj = {
+		.data = data,
+		.size = size,
+		.block_size = block_size,
+		.blocks_per_job = block_size < COMPRESS_CHUNK ? COMPRESS_CHUNK / block_size : 1,
+		.out = out,
+	};
+	const size_t n_blocks = (size + block_size - 1) / block_size;
+	if (n_blocks > 0) uncurl_parallel_for((n_blocks + cj.blocks_per_job - 1) / cj.blocks_per_job, compress_chunk, &cj);
+	return 0;
+}
+
+// pointer scan: each job scans a chunk of words and codes its edges into
+// its own blocks, which are concatenated afterwards. words are checked 4 at
+// a time against the span of all ranges (lo up to 2^span_log2 past it),
+// which most non-pointers (small integers, text, floats) fail at once; the
+// rest are looked up by binary search. a block is POINTER_BLOCK edges, each
+// coded as varints of the source step in words and of the zigzagged target
+// delta; the index keeps the first source and stream position of each
+#define POINTER_CHUNK (1<<22) // bytes per parallel_for() job
+#define POINTER_BLOCK (64) // edges per index entry
+
+typedef uint64_t pointer_u64x4 __attribute__ ((vector_size (32)));
+typedef uint8_t pointer_u8x32 __attribute__ ((vector_size (32)));
+
+struct uncurl_pointer_graph {
+	size_t n_edges, n_blocks;
+	uint64_t* block_source;
+	uint64_t* block_pos; // n_blocks+1; the last is the stream size
+	uint8_t* stream;
+};
+
+struct pointer_chunk {
+	uint8_t* stream;
+	size_t stream_size, stream_cap;
+	uint64_t* block_source;
+	uint64_t* block_pos;
+	size_t n_blocks, blocks_cap;
+	size_t n_edges;
+	uint64_t prev_source, prev_target;
+	size_t first_block, first_pos; // in the graph
+};
+
+struct pointer_job {
+	const uint8_t* data;
+	size_t size;
+	const struct uncurl_address_range* ranges; // sorted by vaddr
+	int n_ranges;
+	int is_swapped;
+	uint64_t lo;
+	int span_log2;
+	struct pointer_chunk* chunks;
+	struct uncurl_pointer_graph* graph;
+};
+
+static uint8_t* pointer_put_varint(uint8_t* p, uint64_t v)
+{
+	while (v >= 0x80) {
+		*(p++) = (uint8_t)v | 0x80;
+		v >>= 7;
+	}
+	*(p++) = v;
+	return p;
+}
+
+static const uint8_t* pointer_get_varint(const uint8_t* p, uint64_t* out)
+{
+	uint64_t v = 0;
+	int shift = 0;
+	while (*p & 0x80) {
+		v |= (uint64_t)(*(p++) & 0x7f) << shift;
+		shift += 7;
+	}
+	*out = v | ((uint64_t)*(p++) << shift);
+	return p;
+}
+
+static void pointer_chunk_add(struct pointer_chunk* pc, uint64_t source, uint64_t target)
+{
+	if ((pc->n_edges % POINTER_BLOCK) == 0) {
+		if (pc->n_blocks == pc->blocks_cap) {
+			pc->blocks_cap = 2*pc->blocks_cap + 16;
+			pc->block_source = realloc(pc->block_source, pc->blocks_cap * sizeof pc->block_source[0]);
+			pc->block_pos = realloc(pc->block_pos, pc->blocks_cap * sizeof pc->block_pos[0]);
+			assert(pc->block_source != NULL && pc->block_pos != NULL);
+		}
+		pc->block_source[pc->n_blocks] = source;
+		pc->block_pos[pc->n_blocks] = pc->stream_size;
+		pc->n_blocks++;
+		pc->prev_source = source;
+		pc->prev_target = 0;
+	}
+	if (pc->stream_size + 20 > pc->stream_cap) {
+		pc->stream_cap = 2*pc->stream_cap + 4096;
+		pc->stream = realloc(pc->stream, pc->stream_cap);
+		assert(pc->stream != NULL);
+	}
+	const int64_t delta = (int64_t)(target - pc->prev_target);
+	uint8_t* p = pc->stream + pc->stream_size;
+	p = pointer_put_varint(p, (source - pc->prev_source) >> 3);
+	p = pointer_put_varint(p, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+	pc->stream_size = p - pc->stream;
+	pc->prev_source = source;
+	pc->prev_target = target;
+	pc->n_edges++;
+}
+
+// the range containing address v, or NULL
+static const struct uncurl_address_range* pointer_find_range(const struct uncurl_address_range* rs, int n, uint64_t v)
+{
+	int lo = 0, hi = n;
+	while (lo < hi) {
+		const int mid = (lo+hi) >> 1;
+		if (rs[mid].vaddr <= v) {
+			lo = mid+1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == 0) return NULL;
+	const struct uncurl_address_range* r = &rs[lo-1];
+	return v - r->vaddr < r->size ? r : NULL;
+}
+
+static void pointer_scan_chunk(void* usr, int chunk)
+{
+	struct pointer_job* pj = usr;
+	struct pointer_chunk* pc = &pj->chunks[chunk];
+	const size_t begin = (size_t)chunk * POINTER_CHUNK;
+	const size_t end = (begin + POINTER_CHUNK < pj->size ? begin + POINTER_CHUNK : pj->size) & ~(size_t)7;
+	const pointer_u64x4 lo = { pj->lo, pj->lo, pj->lo, pj->lo };
+	const int shift = pj->span_log2;
+	size_t offset = begin;
+	for (; offset + 32 <= end; offset += 32) {
+		pointer_u64x4 w;
+		memcpy(&w, pj->data + offset, sizeof w);
+		if (pj->is_swapped) {
+			w = (pointer_u64x4)__builtin_shufflevector((pointer_u8x32)w, (pointer_u8x32)w,
+				7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8, 23,22,21,20,19,18,17,16, 31,30,29,28,27,26,25,24);
+		}
+		// lanes in the span are 0
+		const pointer_u64x4 out = (w - lo) >> shift;
+		if (out[0] && out[1] && out[2] && out[3]) continue;
+		for (int i = 0; i < 4; i++) {
+			if (out[i]) continue;
+			const struct uncurl_address_range* r = pointer_find_range(pj->ranges, pj->n_ranges, w[i]);
+			if (r != NULL) pointer_chunk_add(pc, offset + 8*i, r->offset + (w[i] - r->vaddr));
+		}
+	}
+	for (; offset < end; offset += 8) {
+		uint64_t v;
+		memcpy(&v, pj->data + offset, sizeof v);
+		if (pj->is_swapped) v = __builtin_bswap64(v);
+		const struct uncurl_address_range* r = pointer_find_range(pj->ranges, pj->n_ranges, v);
+		if (r != NULL) pointer_chunk_add(pc, offset, r->offset + (v - r->vaddr));
+	}
+}
+
+static void pointer_gather_chunk(void* usr, int chunk)
+{
+	struct pointer_job* pj = usr;
+	struct pointer_chunk* pc = &pj->chunks[chunk];
+	struct uncurl_pointer_graph* g = pj->graph;
+	if (pc->n_blocks == 0) return;
+	memcpy(g->stream + pc->first_pos, pc->stream, pc->stream_size);
+	for (size_t i = 0; i < pc->n_blocks; i++) {
+		g->block_source[pc->first_block + i] = pc->block_source[i];
+		g->block_pos[pc->first_block + i] = pc->first_pos + pc->block_pos[i];
+	}
+	free(pc->stream);
+	free(pc->block_source);
+	free(pc->block_pos);
+}
+
+static int address_range_compare(const void* va, const void* vb)
+{
+	const struct uncurl_address_range* a = va;
+	const struct uncurl_address_range* b = vb;
+	return a->vaddr < b->vaddr ? -1 : a->vaddr > b->vaddr ? 1 : 0;
+}
+
+struct uncurl_pointer_graph* uncurl_pointer_graph_new(const uint8_t* data, size_t size, const struct uncurl_address_range* ranges, int n_ranges, int is_be)
+{
+	struct uncurl_pointer_graph* g = calloc(1, sizeof *g);
+	assert(g != NULL);
+	struct uncurl_address_range* rs = malloc((n_ranges+1) * sizeof *rs);
+	assert(rs != NULL);
+	int n = 0;
+	for (int i = 0; i < n_ranges; i++) {
+		if (ranges[i].size > 0) rs[n++] = ranges[i];
+	}
+	qsort(rs, n, sizeof *rs, address_range_compare);
+	// the span is that of the first to the last address in any range
+	const uint64_t lo = n > 0 ? rs[0].vaddr : 0;
+	uint64_t last = lo;
+	for (int i = 0; i < n; i++) {
+		const uint64_t e = rs[i].vaddr + (rs[i].size - 1);
+		if (e < rs[i].vaddr) {
+			last = UINT64_MAX;
+		} else if (e > last) {
+			last = e;
+		}
+	}
+	int span_log2 = 0;
+	while (span_log2 < 63 && ((last - lo) >> span_log2) != 0) span_log2++;
+
+	const int n_chunks = (size + POINTER_CHUNK - 1) / POINTER_CHUNK;
+	struct pointer_job pj = {
+		.data = data,
+		.size = size,
+		.ranges = rs,
+		.n_ranges = n,
+		.is_swapped = is_be != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__),
+		.lo = lo,
+		.span_log2 = span_log2,
+		.chunks = calloc(n_chunks + 1, sizeof *pj.chunks),
+		.graph = g,
+	};
+	assert(pj.chunks != NULL);
+	if (n > 0 && n_chunks > 0) uncurl_parallel_for(n_chunks, pointer_scan_chunk, &pj);
+
+	size_t stream_size = 0;
+	for (int i = 0; i < n_chunks; i++) {
+		struct pointer_chunk* pc = &pj.chunks[i];
+		pc->first_block = g->n_blocks;
+		pc->first_pos = stream_size;
+		g->n_blocks += pc->n_blocks;
+		g->n_edges += pc->n_edges;
+		stream_size += pc->stream_size;
+	}
+	g->block_source = malloc((g->n_blocks + 1) * sizeof g->block_source[0]);
+	g->block_pos = malloc((g->n_blocks + 1) * sizeof g->block_pos[0]);
+	g->stream = malloc(stream_size + 1);
+	assert(g->block_source != NULL && g->block_pos != NULL && g->stream != NULL);
+	if (n_chunks > 0) uncurl_parallel_for(n_chunks, pointer_gather_chunk, &pj);
+	g->block_pos[g->n_blocks] = stream_size;
+	free(pj.chunks);
+	free(rs);
+	return g;
+}
+
+size_t uncurl_pointer_graph_n_edges(const struct uncurl_pointer_graph* g)
+{
+	return g->n_edges;
+}
+
+size_t uncurl_pointer_graph_find(const struct uncurl_pointer_graph* g, uint64_t begin, uint64_t end, struct uncurl_edge* out, size_t max)
+{
+	// the last block starting at or before begin
+	size_t lo = 0, hi = g->n_blocks;
+	while (lo < hi) {
+		const size_t mid = (lo+hi) >> 1;
+		if (g->block_source[mid] <= begin) {
+			lo = mid+1;
+		} else {
+			hi = mid;
+		}
+	}
+	size_t n = 0;
+	for (size_t b = lo > 0 ? lo-1 : 0; b < g->n_blocks && n < max; b++) {
+		if (g->block_source[b] >= end) break;
+		const uint8_t* p = g->stream + g->block_pos[b];
+		const uint8_t* p_end = g->stream + g->block_pos[b+1];
+		uint64_t source = g->block_source[b];
+		uint64_t target = 0;
+		while (p < p_end && n < max) {
+			uint64_t step, zz;
+			p = pointer_get_varint(p, &step);
+			p = pointer_get_varint(p, &zz);
+			source += step << 3;
+			target += (zz >> 1) ^ -(zz & 1);
+			if (source >= end) return n;
+			if (source >= begin) out[n++] = (struct uncurl_edge){ .source = source, .target = target };
+		}
+	}
+	return n;
+}
+
+void uncurl_pointer_graph_free(struct uncurl_pointer_graph* g)
+{
+	if (g == NULL) return;
+	free(g->block_source);
+	free(g->block_pos);
+	free(g->stream);
+	free(g);
+}
+
+// printable strings: each job finds the runs in a chunk 32 bytes at a time.
+// the bytes are classified in a vector and packed into a bitmask (8 at a
+// time, by a multiply), and only the mask's transitions are visited. runs
+// touching a chunk's ends are kept whatever their length, to be joined with
+// their neighbours' afterwards
+#define STRINGS_CHUNK (1<<22) // bytes per parallel_for() job
+
+typedef uint8_t strings_u8x16 __attribute__ ((vector_size (16)));
+typedef uint64_t strings_u64x2 __attribute__ ((vector_size (16)));
+
+struct strings_chunk {
+	struct uncurl_string* runs;
+	size_t n_runs, cap_runs;
+	int is_short_of_memory; // runs went missing
+};
+
+struct strings_job {
+	const uint8_t* data;
+	size_t size, min_length;
+	struct strings_chunk* chunks;
+};
+
+static inline int strings_is_printable(uint8_t c)
+{
+	return (uint8_t)(c - 0x20) < 0x5f || c == '\t';
+}
+
+// bit i is set if p[i] is printable; 16 bytes at a time, the widest
+// vectors most targets have
+static inline uint32_t strings_mask16(const uint8_t* p)
+{
+	strings_u8x16 v;
+	memcpy(&v, p, sizeof v);
+	const strings_u8x16 m = (strings_u8x16)(((strings_u8x16)(v - 0x20) < 0x5f) | (v == '\t')) & 1;
+	// byte i of a lane lands on bit 56+i
+	const strings_u64x2 b = ((strings_u64x2)m * 0x0102040810204080ull) >> 56;
+	return b[0] | (b[1] << 8);
+}
+
+static inline uint32_t strings_mask(const uint8_t* p)
+{
+	return strings_mask16(p) | (strings_mask16(p + 16) << 16);
+}
+
+static void strings_add(struct strings_chunk* sc, uint64_t begin, uint64_t end)
+{
+	if (sc->n_runs == sc->cap_runs) {
+		const size_t cap = 2*sc->cap_runs + 256;
+		struct uncurl_string* runs = realloc(sc->runs, cap * sizeof sc->runs[0]);
+		if (runs == NULL) {
+			sc->is_short_of_memory = 1;
+			return;
+		}
+		sc->runs = runs;
+		sc->cap_runs = cap;
+	}
+	sc->runs[sc->n_runs++] = (struct uncurl_string){ .offset = begin, .length = end - begin };
+}
+
+static void strings_scan_chunk(void* usr, int chunk)
+{
+	struct strings_job* sj = usr;
+	struct strings_chunk* sc = &sj->chunks[chunk];
+	const size_t begin = (size_t)chunk * STRINGS_CHUNK;
+	const size_t end = begin + STRINGS_CHUNK < sj->size ? begin + STRINGS_CHUNK : sj->size;
+	size_t run_start = 0;
+	int in_run = 0;
+	size_t offset = begin;
+	for (; offset + 32 <= end; offset += 32) {
+		const uint64_t m = strings_mask(sj->data + offset);
+		if (m == (in_run ? 0xffffffff : 0)) continue;
+		uint64_t t = (m ^ ((m << 1) | in_run)) & 0xffffffff;
+		while (t != 0) {
+			const size_t at = offset + __builtin_ctzll(t);
+			t &= t-1;
+			if (!in_run) {
+				run_start = at;
+			} else if (at - run_start >= sj->min_length || run_start == begin) {
+				strings_add(sc, run_start, at);
+			}
+			in_run = !in_run;
+		}
+	}
+	for (; offset < end; offset++) {
+		if (strings_is_printable(sj->data[offset]) == in_run) continue;
+		if (!in_run) {
+			run_start = offset;
+		} else if (offset - run_start >= sj->min_length || run_start == begin) {
+			strings_add(sc, run_start, offset);
+		}
+		in_run = !in_run;
+	}
+	if (in_run) strings_add(sc, run_start, end);
+}
+
+struct uncurl_string* uncurl_strings_find(const uint8_t* data, size_t size, size_t min_length, size_t* out_n)
+{
+	if (min_length < 1) return NULL;
+	const int n_chunks = (size + STRINGS_CHUNK - 1) / STRINGS_CHUNK;
+	struct strings_job sj = {
+		.data = data,
+		.size = size,
+		.min_length = min_length,
+		.chunks = calloc(n_chunks + 1, sizeof *sj.chunks),
+	};
+	if (sj.chunks == NULL) return NULL;
+	if (n_chunks > 0) uncurl_parallel_for(n_chunks, strings_scan_chunk, &sj);
+
+	size_t n_max = 0;
+	int is_short_of_memory = 0;
+	for (int i = 0; i < n_chunks; i++) {
+		n_max += sj.chunks[i].n_runs;
+		is_short_of_memory |= sj.chunks[i].is_short_of_memory;
+	}
+	struct uncurl_string* out = is_short_of_memory ? NULL : malloc((n_max + 1) * sizeof *out);
+	if (out == NULL) {
+		for (int i = 0; i < n_chunks; i++) free(sj.chunks[i].runs);
+		free(sj.chunks);
+		return NULL;
+	}
+	// runs that meet across chunk ends are joined; a run is only dropped for
+	// being short once the next one shows it can't grow
+	size_t n = 0;
+	for (int i = 0; i < n_chunks; i++) {
+		const struct strings_chunk* sc = &sj.chunks[i];
+		for (size_t j = 0; j < sc->n_runs; j++) {
+			const struct uncurl_string r = sc->runs[j];
+			if (n > 0 && out[n-1].offset + out[n-1].length == r.offset) {
+				out[n-1].length += r.length;
+				continue;
+			}
+			if (n > 0 && out[n-1].length < min_length) n--;
+			out[n++] = r;
+		}
+		free(sc->runs);
+	}
+	if (n > 0 && out[n-1].length < min_length) n--;
+	free(sj.chunks);
+	*out_n = n;
+	return out;
+}
+
+// typed value queries: each value is mapped to an unsigned key of its width
+// that orders like the value does (the sign bit flipped for signed types,
+// every bit of negative floats), so that any range is a single unsigned
+// compare, key-lo <= hi-lo, done on 16 bytes of values at a time. NaN
+// queries compare the magnitude with infinity's instead. big-endian values
+// are swapped with shifts, which every target has. alignments below the
+// width take a pass per offset, alignments up to a vector mask out lanes,
+// and wider ones are sparse enough to go value by value. jobs are whole
+// blocks, so their counts need no locking
+#define VALUES_CHUNK (1<<22) // bytes per parallel_for() job, about
+
+typedef uint8_t values_u8 __attribute__ ((vector_size (16)));
+typedef uint16_t values_u16 __attribute__ ((vector_size (16)));
+typedef uint32_t values_u32 __attribute__ ((vector_size (16)));
+typedef uint64_t values_u64 __attribute__ ((vector_size (16)));
+typedef int8_t values_i8 __attribute__ ((vector_size (16)));
+typedef int16_t values_i16 __attribute__ ((vector_size (16)));
+typedef int32_t values_i32 __attribute__ ((vector_size (16)));
+typedef int64_t values_i64 __attribute__ ((vector_size (16)));
+
+struct values_job {
+	const uint8_t* data;
+	size_t size, block_size, chunk_size, alignment;
+	int width, is_be;
+	int block_shift; // -1 unless block_size is a power of two
+	// key = (x ^ ((x<0 ? ~0 : 0) & flip_negative | flip)) & magnitude; the
+	// value matches if key-lo <= span
+	uint64_t flip_negative, flip, magnitude, lo, span;
+	uint32_t* counts;
+	uint64_t* totals; // per job
+};
+
+static inline uint64_t values_load(const uint8_t* p, int width, int is_be)
+{
+	uint64_t x = 0;
+	for (int i = 0; i < width; i++) x |= (uint64_t)p[is_be ? width-1-i : i] << (8*i);
+	return x;
+}
+
+static inline int values_match(const struct values_job* vj, uint64_t x)
+{
+	const int bits = 8*vj->width;
+	const uint64_t all = ~0ull >> (64-bits);
+	const uint64_t negative = ((x >> (bits-1)) & 1) ? all : 0;
+	const uint64_t key = (x ^ ((negative & vj->flip_negative) | vj->flip)) & vj->magnitude;
+	return ((key - vj->lo) & all) <= vj->span;
+}
+
+static inline void values_hit(const struct values_job* vj, size_t offset, uint64_t* total)
+{
+	(*total)++;
+	if (vj->counts != NULL) vj->counts[vj->block_shift >= 0 ? offset >> vj->block_shift : offset / vj->block_size]++;
+}
+
+static inline values_u8 values_swap8(values_u8 x)
+{
+	return x;
+}
+
+static inline values_u16 values_swap16(values_u16 x)
+{
+	return (x << 8) | (x >> 8);
+}
+
+static inline values_u32 values_swap32(values_u32 x)
+{
+	x = (x << 16) | (x >> 16);
+	return ((x & 0x00ff00ff) << 8) | ((x >> 8) & 0x00ff00ff);
+}
+
+static inline values_u64 values_swap64(values_u64 x)
+{
+	x = (x << 32) | (x >> 32);
+	x = ((x & 0x0000ffff0000ffffull) << 16) | ((x >> 16) & 0x0000ffff0000ffffull);
+	return ((x & 0x00ff00ff00ff00ffull) << 8) | ((x >> 8) & 0x00ff00ff00ff00ffull);
+}
+
+// matches the vectors starting at p, p+16, ... while they end by end; lane i
+// only counts if bit i of lanes is set. returns where it stopped
+#define VALUES_KERNEL(BITS) \
+	static size_t values_vector_##BITS(const struct values_job* vj, size_t p, size_t end, uint32_t lanes, uint64_t* total) \
+	{ \
+		typedef values_u##BITS V; \
+		typedef values_i##BITS S; \
+		enum { N_LANES = 128/BITS }; \
+		const V flip_negative = (V){0} + (uint##BITS##_t)vj->flip_negative; \
+		const V flip = (V){0} + (uint##BITS##_t)vj->flip; \
+		const V magnitude = (V){0} + (uint##BITS##_t)vj->magnitude; \
+		const V lo = (V){0} + (uint##BITS##_t)vj->lo; \
+		const V span = (V){0} + (uint##BITS##_t)vj->span; \
+		V lane_mask = {0}; \
+		for (int i = 0; i < N_LANES; i++) lane_mask[i] = ((lanes >> i) & 1) ? (uint##BITS##_t)~0ull : 0; \
+		for (; p + 16 <= end; p += 16) { \
+			V x; \
+			memcpy(&x, vj->data + p, sizeof x); \
+			if (vj->is_be) x = values_swap##BITS(x); \
+			const V negative = (V)((S)x >> (BITS-1)); \
+			const V key = (x ^ ((negative & flip_negative) | flip)) & magnitude; \
+			const V m = (V)((V)(key - lo) <= span) & lane_mask; \
+			const values_u64 any = (values_u64)m; \
+			if ((any[0] | any[1]) == 0) continue; \
+			for (int i = 0; i < N_LANES; i++) { \
+				if (m[i]) values_hit(vj, p + i*(BITS/8), total); \
+			} \
+		} \
+		return p; \
+	}
+
+VALUES_KERNEL(8)
+VALUES_KERNEL(16)
+VALUES_KERNEL(32)
+VALUES_KERNEL(64)
+
+#undef VALUES_KERNEL
+
+static void values_scan_chunk(void* usr, int chunk)
+{
+	struct values_job* vj = usr;
+	const size_t w = vj->width;
+	const size_t a = vj->alignment;
+	const size_t c0 = (size_t)chunk * vj->chunk_size;
+	const size_t c1 = vj->size - c0 < vj->chunk_size ? vj->size : c0 + vj->chunk_size;
+	uint64_t total = 0;
+	if (a > 16) {
+		for (size_t p = (c0 + a-1) & ~(a-1); p < c1 && p + w <= vj->size; p += a) {
+			if (values_match(vj, values_load(vj->data + p, w, vj->is_be))) values_hit(vj, p, &total);
+		}
+		vj->totals[chunk] = total;
+		return;
+	}
+	// c0 is a multiple of 16, and so of a; a vector at c0 + k*a holds the
+	// values at offsets k*a (mod w)
+	uint32_t lanes = 0;
+	for (size_t i = 0; i < 16/w; i++) {
+		if (((i*w) & (a-1)) == 0) lanes |= 1u << i;
+	}
+	const size_t n_passes = a < w ? w/a : 1;
+	for (size_t k = 0; k < n_passes; k++) {
+		// the last value of a vector ending by c1 + k*a starts before c1
+		const size_t end = c1 + k*a < vj->size ? c1 + k*a : vj->size;
+		size_t p = c0 + k*a;
+		switch (w) {
+		case 1: p = values_vector_8(vj, p, end, lanes, &total); break;
+		case 2: p = values_vector_16(vj, p, end, lanes, &total); break;
+		case 4: p = values_vector_32(vj, p, end, lanes, &total); break;
+		case 8: p = values_vector_64(vj, p, end, lanes, &total); break;
+		default: assert(!"bad width");
+		}
+		for (; p < c1 && p + w <= vj->size; p += w) {
+			if ((p & (a-1)) == 0 && values_match(vj, values_load(vj->data + p, w, vj->is_be))) values_hit(vj, p, &total);
+		}
+	}
+	vj->totals[chunk] = total;
+}
+
+// bits of a float bound, as a key
+static uint64_t values_float_key(double f, int width)
+{
+	uint64_t x;
+	if (width == 4) {
+		const float ff = f;
+		uint32_t x32;
+		memcpy(&x32, &ff, sizeof x32);
+		x = x32;
+	} else {
+		memcpy(&x, &f, sizeof x);
+	}
+	const uint64_t all = ~0ull >> (64 - 8*width);
+	const uint64_t sign = (all >> 1) + 1;
+	return (x & sign) ? ~x & all : x | sign;
+}
+
+int64_t uncurl_values_count(const uint8_t* data, size_t size, const struct uncurl_value_query* q, size_t block_size, uint32_t* counts)
+{
+	const int w = q->width;
+	if (w != 1 && w != 2 && w != 4 && w != 8) return -1;
+	if (q->type != UNCURL_VALUE_UNSIGNED && q->type != UNCURL_VALUE_SIGNED && q->type != UNCURL_VALUE_FLOAT) return -1;
+	if (q->type == UNCURL_VALUE_FLOAT && w < 4) return -1;
+	if (q->alignment == 0 || (q->alignment & (q->alignment-1)) != 0) return -1;
+	if (block_size == 0) return -1;
+	if (counts != NULL) memset(counts, 0, ((size + block_size - 1) / block_size) * sizeof counts[0]);
+	const uint64_t all = ~0ull >> (64 - 8*w);
+	const uint64_t sign = (all >> 1) + 1;
+	struct values_job vj = {
+		.data = data,
+		.size = size,
+		.block_size = block_size,
+		.alignment = q->alignment,
+		.width = w,
+		.is_be = q->is_be,
+		.block_shift = -1,
+		.magnitude = all,
+		.counts = counts,
+	};
+	uint64_t lo, hi;
+	if (q->type == UNCURL_VALUE_UNSIGNED) {
+		if (q->lo.u > q->hi.u || q->lo.u > all) return 0;
+		lo = q->lo.u;
+		hi = q->hi.u < all ? q->hi.u : all;
+	} else if (q->type == UNCURL_VALUE_SIGNED) {
+		const int64_t min = (int64_t)~(all >> 1);
+		const int64_t max = (int64_t)(all >> 1);
+		const int64_t l = q->lo.i > min ? q->lo.i : min;
+		const int64_t h = q->hi.i < max ? q->hi.i : max;
+		if (l > h) return 0;
+		vj.flip = sign;
+		lo = ((uint64_t)l ^ sign) & all;
+		hi = ((uint64_t)h ^ sign) & all;
+	} else if (q->is_nan) {
+		const uint64_t inf = values_float_key(INFINITY, w) & (all >> 1);
+		vj.magnitude = all >> 1;
+		lo = inf + 1;
+		hi = all >> 1;
+	} else {
+		double l = q->lo.f, h = q->hi.f;
+		if (isnan(l) || isnan(h) || l > h) return 0;
+		if (w == 4) {
+			// rounded inwards, so the range doesn't grow
+			float lf = l, hf = h;
+			if (lf < l) lf = nextafterf(lf, INFINITY);
+			if (hf > h) hf = nextafterf(hf, -INFINITY);
+			if (lf > hf) return 0;
+			l = lf;
+			h = hf;
+		}
+		// both zeros are in ranges ending at zero
+		if (l == 0.0) l = -0.0;
+		if (h == 0.0) h = 0.0;
+		vj.flip = sign;
+		vj.flip_negative = all;
+		lo = values_float_key(l, w);
+		hi = values_float_key(h, w);
+	}
+	vj.lo = lo;
+	vj.span = hi - lo;
+	if (size < (size_t)w) return 0;
+
+	// whole blocks per job, a multiple of 16 bytes
+	size_t unit = 16;
+	if (counts != NULL) {
+		unit = block_size;
+		while (unit % 16 != 0) unit += block_size;
+		if ((block_size & (block_size-1)) == 0) vj.block_shift = __builtin_ctzll(block_size);
+	}
+	vj.chunk_size = unit * ((VALUES_CHUNK + unit - 1) / unit);
+	const int n_chunks = (size + vj.chunk_size - 1) / vj.chunk_size;
+	vj.totals = malloc(n_chunks * sizeof vj.totals[0]);
+	if (vj.totals == NULL) return -1;
+	uncurl_parallel_for(n_chunks, values_scan_chunk, &vj);
+	uint64_t total = 0;
+	for (int i = 0; i < n_chunks; i++) total += vj.totals[i];
+	free(vj.totals);
+	return total;
+}
+
+struct render_view_job {
+	const uint8_t* data;
+	size_t n_points;
+	int width_log2;
+	const struct uncurl_view* view;
+	uint8_t* out;
+	int out_width, out_height;
+	size_t out_stride;
+};
+
+static void render_view_row(void* usr, int row)
+{
+	struct render_view_job* rv = usr;
+	const int width = 1 << rv->width_log2;
+	const struct uncurl_view* v = rv->view;
+	uint8_t* wp = rv->out + (size_t)row * rv->out_stride;
+	memset(wp, 0, (size_t)rv->out_width * N_COMP);
+	// same mapping as the viewer: the image is centered, then panned and
+	// scaled about the output center
+	const double ly = (row + 0.5 - rv->out_height*0.5 - v->pan_y) / v->scale + width*0.5;
+	if (!(0 <= ly && ly < width)) return;
+	const double x0 = (0.5 - rv->out_width*0.5 - v->pan_x) / v->scale + width*0.5;
+	const double dx = 1.0 / v->scale;
+	uint32_t xs[1<<10], ys[1<<10];
+	uint64_t ds[1<<10];
+	int col = 0;
+	while (col < rv->out_width) {
+		int n = 0, col0 = -1;
+		for (; col < rv->out_width && n < (int)ARRAY_LENGTH(xs); col++) {
+			const double lx = x0 + col*dx;
+			if (!(0 <= lx && lx < width)) {
+				if (n > 0) break;
+				continue;
+			}
+			if (n == 0) col0 = col;
+			xs[n] = lx;
+			ys[n] = ly;
+			n++;
+		}
+		if (n == 0) continue;
+		hilbert_xy2d_run(rv->width_log2, n, xs, ys, ds);
+		for (int i = 0; i < n; i++) {
+			if (ds[i] >= rv->n_points) continue;
+			memcpy(&wp[(size_t)(col0+i)*N_COMP], &rv->data[ds[i]*N_COMP], N_COMP);
+		}
+	}
+}
+
+void uncurl_render_view(const uint8_t* data, size_t n_points, int width_log2, const struct uncurl_view* view, uint8_t* out, int out_width, int out_height, size_t out_stride)
+{
+	struct render_view_job rv = {
+		.data = data,
+		.n_points = n_points,
+		.width_log2 = width_log2,
+		.view = view,
+		.out = out,
+		.out_width = out_width,
+		.out_height = out_height,
+		.out_stride = out_stride,
+	};
+	uncurl_parallel_for(out_height, render_view_row, &rv);
+}
@@ -11,6 +11,8 @@
 #define MOUSE_BUTTON_PAN (3) // RMB
 #endif
 
+#define _GNU_SOURCE // copy_file_range()
+
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
@@ -18,202 +20,4100 @@
 #include <assert.h>
 #include <math.h>
 
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <elf.h>
+#include <stddef.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include <pthread.h>
+
 #include <SDL.h>
 
+#include "uncurl.h"
+
 #define ARRAY_LENGTH(xs) (sizeof(xs)/sizeof(xs[0]))
-#define N_COMP (3) // RGB, not really configurable, but convenient define nevertheless
+#define N_COMP (UNCURL_N_COMP) // RGB, not really configurable, but convenient define nevertheless
 
-uint8_t* read_entire_file(const char* path, size_t* out_size)
+__attribute__ ((noreturn))
+static void SDL2FATAL(void)
+{
+	fprintf(stderr, "SDL2: %s\n", SDL_GetError());
+	exit(EXIT_FAILURE);
+}
+
+static int starts_with(const char* s, const char* prefix, const char** out_tail)
+{
+	const size_t np = strlen(prefix);
+	if (strlen(s) >= np && memcmp(s, prefix, np) == 0) {
+		if (out_tail != NULL) *out_tail = s+np;
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+static double get_time(void)
+{
+	return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+static int window_width, window_height;
+static double pan_x = 0.0;
+static double pan_y = 0.0;
+static double scale = 1.0;
+
+static void map_screen_to_local(double sx, double sy, double* out_lx, double* out_ly)
+{
+	const double mid_x = (double)window_width * 0.5;
+	const double mid_y = (double)window_height * 0.5;
+	double lx = (sx - mid_x - pan_x) / scale;
+	double ly = (sy - mid_y - pan_y) / scale;
+	if (out_lx) *out_lx = lx;
+	if (out_ly) *out_ly = ly;
+}
+
+// maps a screen position to the 1D point drawn there; returns -1 if there
+// is none
+static int64_t screen_to_point(int mx, int my, int width_log2, size_t n_points)
+{
+	const int64_t width = (int64_t)1<<width_log2;
+	double lx,ly;
+	map_screen_to_local(mx, my, &lx, &ly);
+	lx += width/2;
+	ly += width/2;
+	if (!(0 <= lx && lx < width && 0 <= ly && ly < width)) return -1;
+	const uint32_t ix = lx;
+	const uint32_t iy = ly;
+	uint64_t d;
+	uncurl_xy2d(width_log2, 1, &ix, &iy, &d);
+	return d < n_points ? (int64_t)d : -1;
+}
+
+// split view: the window can be split into side by side panes, each with
+// its own pan and zoom, that all draw the same textures (LOD levels and
+// overview included), so another pane costs drawing time but no memory or
+// loading. the view globals above always describe the current pane;
+// pane_select() swaps them. with linked zoom, zooming one pane zooms the
+// others about their centers.
+#define MAX_PANES (2)
+
+struct pane {
+	double pan_x, pan_y, scale;
+	SDL_Rect rect; // in the window
+};
+
+static struct pane panes[MAX_PANES] = { { .scale = 1.0 } };
+static int n_panes = 1;
+static int current_pane = 0;
+static int is_zoom_linked = 0;
+
+static void pane_select(int i)
+{
+	struct pane* p = &panes[current_pane];
+	p->pan_x = pan_x;
+	p->pan_y = pan_y;
+	p->scale = scale;
+	current_pane = i;
+	p = &panes[i];
+	pan_x = p->pan_x;
+	pan_y = p->pan_y;
+	scale = p->scale;
+	window_width = p->rect.w;
+	window_height = p->rect.h;
+}
+
+static void panes_layout(int width, int height)
+{
+	for (int i = 0; i < n_panes; i++) {
+		const int x0 = (width * i) / n_panes;
+		const int x1 = (width * (i+1)) / n_panes;
+		panes[i].rect = (SDL_Rect){ .x = x0, .y = 0, .w = x1 - x0, .h = height };
+	}
+	pane_select(current_pane < n_panes ? current_pane : 0);
+}
+
+static int pane_at(int x)
+{
+	for (int i = n_panes-1; i > 0; i--) {
+		if (x >= panes[i].rect.x) return i;
+	}
+	return 0;
+}
+
+// one pane, or two showing the same view to begin with
+static void panes_toggle_split(void)
+{
+	pane_select(0);
+	if (n_panes == 1) {
+		panes[1] = panes[0];
+		n_panes = 2;
+	} else {
+		n_panes = 1;
+	}
+}
+
+// call after the current pane's scale changed from prev_scale
+static void panes_sync_zoom(double prev_scale)
+{
+	if (!is_zoom_linked || n_panes == 1) return;
+	const double f = scale / prev_scale;
+	for (int i = 0; i < n_panes; i++) {
+		if (i == current_pane) continue;
+		panes[i].scale *= f;
+		panes[i].pan_x *= f;
+		panes[i].pan_y *= f;
+	}
+}
+
+static void panes_reset_views(void)
+{
+	for (int i = 0; i < n_panes; i++) {
+		panes[i].pan_x = panes[i].pan_y = 0.0;
+		panes[i].scale = 1.0;
+	}
+	pan_x = pan_y = 0.0;
+	scale = 1.0;
+}
+
+// overlay that outlines the region each file occupies on the curve
+static SDL_Texture* input_set_boundary_texture_new(struct uncurl_input_set* set, SDL_Renderer* renderer, int width_log2, size_t n_points)
+{
+	const int width = 1<<width_log2;
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, width, width);
+	if (texture == NULL) SDL2FATAL();
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	int* file_rows[2];
+	for (int i = 0; i < 2; i++) file_rows[i] = malloc(width * sizeof(int));
+	uint32_t* row = malloc(width * sizeof(uint32_t));
+	uint32_t* xs = malloc(width * sizeof(uint32_t));
+	uint32_t* ys = malloc(width * sizeof(uint32_t));
+	uint64_t* ds = malloc(width * sizeof(uint64_t));
+	for (int x = 0; x < width; x++) xs[x] = x;
+	const uint32_t edge = 0xc0ffffff; // RGBA32 is byte order R,G,B,A
+	for (int y = 0; y < width; y++) {
+		int* cur = file_rows[y&1];
+		int* prev = file_rows[(y&1)^1];
+		for (int x = 0; x < width; x++) ys[x] = y;
+		uncurl_xy2d(width_log2, width, xs, ys, ds);
+		for (int x = 0; x < width; x++) {
+			cur[x] = ds[x] < n_points ? uncurl_input_set_find(set, (size_t)ds[x]*N_COMP) : -1;
+		}
+		for (int x = 0; x < width; x++) {
+			int is_edge = 0;
+			if (x > 0 && cur[x-1] != cur[x]) is_edge = 1;
+			if (y > 0 && prev[x] != cur[x]) is_edge = 1;
+			row[x] = is_edge ? edge : 0;
+		}
+		SDL_Rect r = { .x = 0, .y = y, .w = width, .h = 1 };
+		SDL_UpdateTexture(texture, &r, row, width * sizeof row[0]);
+	}
+	free(row);
+	free(xs);
+	free(ys);
+	free(ds);
+	for (int i = 0; i < 2; i++) free(file_rows[i]);
+	return texture;
+}
+
+// uploads tiles of image that are set in either dirty0 or dirty1 (which may
+// be NULL); there are 1<<(width_log2-tile_log2) tiles per row
+static void upload_tiles(SDL_Texture* texture, const uint8_t* image, int width_log2, int tile_log2, const uint8_t* dirty0, const uint8_t* dirty1)
+{
+	const int width = 1<<width_log2;
+	const int tile = 1<<tile_log2;
+	const int tiles_log2 = width_log2 - tile_log2;
+	const int n = 1<<tiles_log2;
+	#define IS_DIRTY(i) (dirty0[i] || (dirty1 != NULL && dirty1[i]))
+	for (int ty = 0; ty < n; ty++) {
+		// coalesce horizontal runs of dirty tiles into one update
+		const int i0 = (ty << tiles_log2);
+		int tx = 0;
+		while (tx < n) {
+			if (!IS_DIRTY(i0+tx)) {
+				tx++;
+				continue;
+			}
+			int tx1 = tx+1;
+			while (tx1 < n && IS_DIRTY(i0+tx1)) tx1++;
+			SDL_Rect r = { .x = tx*tile, .y = ty*tile, .w = (tx1-tx)*tile, .h = tile };
+			SDL_UpdateTexture(texture, &r, &image[((size_t)r.y*width + r.x)*N_COMP], N_COMP*width);
+			tx = tx1;
+		}
+	}
+	#undef IS_DIRTY
+}
+
+// frame-sequence playback: the input is a sequence of equal-sized frames
+// (from one or more files) that are read and curled ahead of time on a
+// worker thread, and uploaded to double-buffered streaming textures.
+
+#define PLAYER_TILE_LOG2 (6)
+
+struct player_frame {
+	int fd; // -1 means "in memory"
+	const uint8_t* mem;
+	off_t offset;
+};
+
+enum player_slot_state {
+	PLAYER_SLOT_EMPTY = 0,
+	PLAYER_SLOT_BUSY,
+	PLAYER_SLOT_READY,
+};
+
+struct player_slot {
+	enum player_slot_state state;
+	int frame;
+	int generation;
+	int full; // if set, dirty[] is meaningless; everything changed
+	uint8_t* image;
+	uint8_t* dirty; // one per tile; set if tile differs from previous frame
+};
+
+struct player {
+	size_t frame_size;
+	int n_frames;
+	struct player_frame* frames;
+
+	int width_log2, n_pixels;
+	int tile_log2, tiles_log2, n_tiles;
+	int* tile_of_block;
+
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int is_exiting;
+	int generation;
+	int next_frame;
+	struct player_slot slots[2];
+
+	// worker private
+	uint8_t* raw[2];
+	int raw_frame[2];
+	int raw_index;
+
+	// main thread private
+	SDL_Texture* textures[2];
+	int texture_frame[2];
+	int display;
+	int current_frame;
+	int want_frame;
+	uint8_t* last_dirty;
+	int last_full;
+};
+
+static int player_add_file(struct player* pl, const char* path)
+{
+	int fd = -1;
+	const uint8_t* mem = NULL;
+	size_t size;
+	if (strcmp(path, "-") == 0) {
+		mem = uncurl_read_entire_file(path, &size);
+		if (mem == NULL) {
+			fprintf(stderr, "%s: could not read\n", path);
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		fd = open(path, O_RDONLY);
+		if (fd == -1) {
+			fprintf(stderr, "%s: could not open\n", path);
+			exit(EXIT_FAILURE);
+		}
+		struct stat st;
+		if (fstat(fd, &st) == -1) {
+			fprintf(stderr, "%s: could not stat\n", path);
+			exit(EXIT_FAILURE);
+		}
+		size = st.st_size;
+	}
+	const int n = size / pl->frame_size;
+	if ((size % pl->frame_size) != 0) {
+		fprintf(stderr, "%s: ignoring trailing partial frame (%zu bytes)\n", path, size % pl->frame_size);
+	}
+	pl->frames = realloc(pl->frames, (pl->n_frames + n) * sizeof pl->frames[0]);
+	assert(pl->frames != NULL);
+	for (int i = 0; i < n; i++) {
+		struct player_frame* f = &pl->frames[pl->n_frames++];
+		f->fd = fd;
+		f->mem = mem;
+		f->offset = (off_t)i * pl->frame_size;
+	}
+	return n;
+}
+
+static void player_read_frame(struct player* pl, int frame, uint8_t* dst)
+{
+	assert(0 <= frame && frame < pl->n_frames);
+	struct player_frame* f = &pl->frames[frame];
+	if (f->fd == -1) {
+		memcpy(dst, f->mem + f->offset, pl->frame_size);
+		return;
+	}
+	size_t n = 0;
+	while (n < pl->frame_size) {
+		const ssize_t r = pread(f->fd, dst+n, pl->frame_size-n, f->offset+n);
+		if (r <= 0) {
+			// file shrunk under us? show what we have
+			memset(dst+n, 0, pl->frame_size-n);
+			break;
+		}
+		n += r;
+	}
+}
+
+static void* player_thread(void* usr)
+{
+	struct player* pl = usr;
+	const size_t block_size = ((size_t)1 << (2*pl->tile_log2)) * N_COMP;
+	const int n_blocks = (pl->frame_size + block_size - 1) / block_size;
+	pthread_mutex_lock(&pl->mutex);
+	for (;;) {
+		struct player_slot* slot = NULL;
+		while (!pl->is_exiting) {
+			for (int i = 0; i < ARRAY_LENGTH(pl->slots); i++) {
+				if (pl->slots[i].state == PLAYER_SLOT_EMPTY) {
+					slot = &pl->slots[i];
+					break;
+				}
+			}
+			if (slot != NULL) break;
+			pthread_cond_wait(&pl->cond, &pl->mutex);
+		}
+		if (pl->is_exiting) break;
+		const int frame = pl->next_frame;
+		const int generation = pl->generation;
+		pl->next_frame = (frame + 1) % pl->n_frames;
+		slot->state = PLAYER_SLOT_BUSY;
+		pthread_mutex_unlock(&pl->mutex);
+
+		const int prev = pl->raw_index;
+		const int cur = prev ^ 1;
+		uint8_t* raw = pl->raw[cur];
+		player_read_frame(pl, frame, raw);
+		pl->raw_frame[cur] = frame;
+		pl->raw_index = cur;
+		// curled a tile at a time on the pool; no permutation to gather
+		// through, and as many cores as there are
+		uncurl_rasterize(raw, pl->frame_size / N_COMP, pl->width_log2, slot->image, (size_t)N_COMP << pl->width_log2);
+
+		// Hilbert curve blocks of 4^k points that are aligned in 1D are
+		// squares in 2D, so delta detection is a memcmp per block
+		slot->full = (pl->raw_frame[prev] != frame-1);
+		if (!slot->full) {
+			memset(slot->dirty, 0, pl->n_tiles);
+			const uint8_t* a = pl->raw[prev];
+			for (int b = 0; b < n_blocks; b++) {
+				const size_t o = b*block_size;
+				const size_t n = (o+block_size) <= pl->frame_size ? block_size : pl->frame_size-o;
+				if (memcmp(a+o, raw+o, n) != 0) slot->dirty[pl->tile_of_block[b]] = 1;
+			}
+		}
+
+		pthread_mutex_lock(&pl->mutex);
+		slot->frame = frame;
+		slot->generation = generation;
+		slot->state = (generation == pl->generation) ? PLAYER_SLOT_READY : PLAYER_SLOT_EMPTY;
+		pthread_cond_broadcast(&pl->cond);
+	}
+	pthread_mutex_unlock(&pl->mutex);
+	return NULL;
+}
+
+static void player_init(struct player* pl, SDL_Renderer* renderer, int width_log2)
+{
+	assert(pl->n_frames > 0);
+	pl->width_log2 = width_log2;
+	pl->n_pixels = 1<<(2*width_log2);
+	pl->tile_log2 = width_log2 < PLAYER_TILE_LOG2 ? width_log2 : PLAYER_TILE_LOG2;
+	pl->tiles_log2 = width_log2 - pl->tile_log2;
+	pl->n_tiles = 1<<(2*pl->tiles_log2);
+
+	// the first point of each block says which tile it covers
+	pl->tile_of_block = calloc(pl->n_tiles, sizeof pl->tile_of_block[0]);
+	uint64_t* ds = malloc(pl->n_tiles * sizeof ds[0]);
+	uint32_t* xs = malloc(pl->n_tiles * sizeof xs[0]);
+	uint32_t* ys = malloc(pl->n_tiles * sizeof ys[0]);
+	assert(pl->tile_of_block != NULL && ds != NULL && xs != NULL && ys != NULL);
+	for (int b = 0; b < pl->n_tiles; b++) ds[b] = (uint64_t)b << (2*pl->tile_log2);
+	uncurl_d2xy(width_log2, pl->n_tiles, ds, xs, ys);
+	for (int b = 0; b < pl->n_tiles; b++) {
+		pl->tile_of_block[b] = ((ys[b] >> pl->tile_log2) << pl->tiles_log2) + (xs[b] >> pl->tile_log2);
+	}
+	free(ds);
+	free(xs);
+	free(ys);
+
+	for (int i = 0; i < ARRAY_LENGTH(pl->slots); i++) {
+		struct player_slot* slot = &pl->slots[i];
+		slot->image = calloc(pl->n_pixels, N_COMP);
+		slot->dirty = calloc(pl->n_tiles, 1);
+		assert(slot->image != NULL && slot->dirty != NULL);
+	}
+	for (int i = 0; i < ARRAY_LENGTH(pl->raw); i++) {
+		pl->raw[i] = malloc(pl->frame_size);
+		assert(pl->raw[i] != NULL);
+		pl->raw_frame[i] = -2;
+	}
+	pl->last_dirty = calloc(pl->n_tiles, 1);
+
+	const int width = 1<<width_log2;
+	for (int i = 0; i < ARRAY_LENGTH(pl->textures); i++) {
+		assert((N_COMP == 3) && "hardcoded pixel format needs N_COMP==3");
+		pl->textures[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, width, width);
+		if (pl->textures[i] == NULL) SDL2FATAL();
+		pl->texture_frame[i] = -1;
+	}
+	pl->current_frame = -1;
+
+	pthread_mutex_init(&pl->mutex, NULL);
+	pthread_cond_init(&pl->cond, NULL);
+	if (pthread_create(&pl->thread, NULL, player_thread, pl) != 0) {
+		fprintf(stderr, "could not create player thread\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void player_seek(struct player* pl, int frame)
+{
+	frame %= pl->n_frames;
+	if (frame < 0) frame += pl->n_frames;
+	pthread_mutex_lock(&pl->mutex);
+	pl->generation++;
+	pl->next_frame = frame;
+	pl->want_frame = frame;
+	for (int i = 0; i < ARRAY_LENGTH(pl->slots); i++) {
+		if (pl->slots[i].state == PLAYER_SLOT_READY) pl->slots[i].state = PLAYER_SLOT_EMPTY;
+	}
+	pthread_cond_broadcast(&pl->cond);
+	pthread_mutex_unlock(&pl->mutex);
+}
+
+// uploads the next decoded frame if there is one. returns 1 if the
+// displayed frame changed
+static int player_present_next(struct player* pl, int use_delta, int block)
+{
+	struct player_slot* slot = NULL;
+	pthread_mutex_lock(&pl->mutex);
+	for (;;) {
+		for (int i = 0; i < ARRAY_LENGTH(pl->slots); i++) {
+			struct player_slot* s = &pl->slots[i];
+			if (s->state != PLAYER_SLOT_READY || s->generation != pl->generation) continue;
+			if (s->frame == pl->want_frame) slot = s;
+		}
+		if (slot != NULL || !block) break;
+		pthread_cond_wait(&pl->cond, &pl->mutex);
+	}
+	pthread_mutex_unlock(&pl->mutex);
+	if (slot == NULL) return 0;
+
+	// the back texture holds the frame before the previous one, so it
+	// needs both the previous and the current frame's dirty tiles
+	const int back = pl->display ^ 1;
+	const int width = 1<<pl->width_log2;
+	const int can_delta = use_delta
+		&& !slot->full && !pl->last_full
+		&& pl->current_frame == slot->frame-1
+		&& pl->texture_frame[back] == slot->frame-2;
+	if (can_delta) {
+		upload_tiles(pl->textures[back], slot->image, pl->width_log2, pl->tile_log2, slot->dirty, pl->last_dirty);
+	} else {
+		SDL_UpdateTexture(pl->textures[back], NULL, slot->image, N_COMP*width);
+	}
+	pl->last_full = slot->full;
+	if (!slot->full) memcpy(pl->last_dirty, slot->dirty, pl->n_tiles);
+	pl->texture_frame[back] = slot->frame;
+	pl->display = back;
+	pl->current_frame = slot->frame;
+	pl->want_frame = (slot->frame + 1) % pl->n_frames;
+
+	pthread_mutex_lock(&pl->mutex);
+	slot->state = PLAYER_SLOT_EMPTY;
+	pthread_cond_broadcast(&pl->cond);
+	pthread_mutex_unlock(&pl->mutex);
+	return 1;
+}
+
+// level-of-detail for the static view: box-filtered reductions of the input
+// (see uncurl_reduce()) are rasterized in the background after load, coarse
+// levels first, and uploaded when first needed. the view is drawn from the
+// level matching the zoom (which also tames the moiré when zoomed out), and
+// from a coarser one while panning/zooming, until input has been idle for
+// LOD_IDLE_TIME.
+
+#define LOD_MOTION_BIAS (2) // levels coarser than the zoom calls for, while moving
+#define LOD_IDLE_TIME (0.25) // seconds
+
+struct lod {
+	const uint8_t* data;
+	size_t n_points;
+	int width_log2;
+	pthread_mutex_t mutex;
+	uint8_t* images[32]; // images[k] is 1<<(width_log2-k) wide; set when ready
+	SDL_Texture* textures[32];
+};
+
+// one background pool job; the reductions and rasterizations in it are
+// parallel at the same priority
+static void lod_build(void* usr, int job)
+{
+	struct lod* lod = usr;
+	// each reduction is made from the one below, which is cheap compared
+	// to rasterizing; then rasterize coarse to fine so motion LOD is
+	// available early
+	uint8_t* reduced[32] = {0};
+	size_t n_reduced[32] = {0};
+	const uint8_t* prev = lod->data;
+	size_t n_prev = lod->n_points;
+	for (int k = 1; k <= lod->width_log2; k++) {
+		n_reduced[k] = (n_prev + 3) / 4;
+		reduced[k] = malloc(n_reduced[k] * N_COMP);
+		assert(reduced[k] != NULL);
+		uncurl_reduce(prev, n_prev, 1, reduced[k]);
+		prev = reduced[k];
+		n_prev = n_reduced[k];
+	}
+	for (int k = lod->width_log2; k >= 1; k--) {
+		const int level_width_log2 = lod->width_log2 - k;
+		uint8_t* image = malloc((size_t)N_COMP << (2*level_width_log2));
+		assert(image != NULL);
+		uncurl_rasterize(reduced[k], n_reduced[k], level_width_log2, image, (size_t)N_COMP << level_width_log2);
+		free(reduced[k]);
+		pthread_mutex_lock(&lod->mutex);
+		lod->images[k] = image;
+		pthread_mutex_unlock(&lod->mutex);
+	}
+}
+
+static struct lod* lod_new(const uint8_t* data, size_t n_points, int width_log2)
+{
+	struct lod* lod = calloc(1, sizeof *lod);
+	assert(lod != NULL);
+	lod->data = data;
+	lod->n_points = n_points;
+	lod->width_log2 = width_log2;
+	pthread_mutex_init(&lod->mutex, NULL);
+	uncurl_batch_release(uncurl_submit(1, lod_build, lod, UNCURL_PRIORITY_BACKGROUND));
+	return lod;
+}
+
+// returns the texture for level, or for the closest finer level that's
+// ready; NULL means the full resolution texture
+static SDL_Texture* lod_texture(struct lod* lod, SDL_Renderer* renderer, int level, int* out_level)
+{
+	if (level > lod->width_log2) level = lod->width_log2;
+	for (int k = level; k >= 1; k--) {
+		if (lod->textures[k] == NULL) {
+			pthread_mutex_lock(&lod->mutex);
+			uint8_t* image = lod->images[k];
+			lod->images[k] = NULL;
+			pthread_mutex_unlock(&lod->mutex);
+			if (image == NULL) continue;
+			const int w = 1 << (lod->width_log2 - k);
+			assert((N_COMP == 3) && "hardcoded pixel format needs N_COMP==3");
+			lod->textures[k] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STATIC, w, w);
+			if (lod->textures[k] == NULL) SDL2FATAL();
+			SDL_UpdateTexture(lod->textures[k], NULL, image, N_COMP*w);
+			free(image);
+		}
+		*out_level = k;
+		return lod->textures[k];
+	}
+	*out_level = 0;
+	return NULL;
+}
+
+// overview loading for inputs too big to read up front: the view shows one
+// pixel per aligned block of 4^level points. a sparse sample (one point per
+// block of a coarser grid, fetched with pread()s spread across the file)
+// gives a picture right away; then pool jobs replace it tile by tile
+// with exact block averages, picking the unfinished tile nearest the center
+// of the viewport first. a tile that leaves the viewport while it's being
+// read is dropped (and picked up again later) if there are visible tiles
+// waiting.
+
+#define OVERVIEW_MAX_LOG2 (12) // overview width; 4096x4096
+#define OVERVIEW_AUTO_LOG2 (14) // used by default for curves wider than 1<<14
+#define OVERVIEW_TILE_LOG2 (6)
+#define OVERVIEW_SAMPLE_LOG2 (7) // sample grid width; 16384 pread()s
+#define OVERVIEW_READ_CHUNK (1<<22) // bytes
+
+enum overview_tile_state {
+	OVERVIEW_TILE_SAMPLED = 0,
+	OVERVIEW_TILE_LOADING,
+	OVERVIEW_TILE_DONE,
+};
+
+struct overview {
+	int fd;
+	size_t n_points;
+	int width_log2; // of the full curve
+	int level; // each overview pixel is the average of 4^level points
+	int ov_width_log2; // width_log2 - level
+	int tile_log2, tiles_log2;
+	uint8_t* image;
+	uint8_t* tile_state; // indexed by (ty << tiles_log2) + tx
+	uint8_t* dirty; // tiles finished since the last upload
+	int n_done;
+	// the viewport in overview pixels, set by the UI thread
+	int view_x0, view_y0, view_x1, view_y1;
+	pthread_mutex_t mutex;
+};
+
+struct overview_sample_job {
+	struct overview* ov;
+	int sample_log2;
+};
+
+static void overview_sample(void* usr, int job)
+{
+	struct overview_sample_job* sj = usr;
+	struct overview* ov = sj->ov;
+	const int n = 1 << (2*sj->sample_log2);
+	const int per_job = 256;
+	const int shift = ov->ov_width_log2 - sj->sample_log2;
+	const size_t block = (size_t)1 << (2*(ov->width_log2 - sj->sample_log2));
+	const int side = 1 << shift;
+	const size_t stride = (size_t)N_COMP << ov->ov_width_log2;
+	for (int j = job*per_job; j < n && j < (job+1)*per_job; j++) {
+		// the middle of the block is as good a guess as any
+		const size_t p = (size_t)j*block + block/2;
+		uint8_t rgb[N_COMP] = {0};
+		if (p < ov->n_points && pread(ov->fd, rgb, N_COMP, (off_t)p*N_COMP) != N_COMP) memset(rgb, 0, N_COMP);
+		const uint64_t d = j;
+		uint32_t x, y;
+		uncurl_d2xy(sj->sample_log2, 1, &d, &x, &y);
+		for (int yy = 0; yy < side; yy++) {
+			uint8_t* wp = &ov->image[((size_t)(y << shift) + yy)*stride + ((size_t)x << shift)*N_COMP];
+			for (int xx = 0; xx < side; xx++) {
+				for (int c=0; c<N_COMP; c++) *(wp++) = rgb[c];
+			}
+		}
+	}
+}
+
+static int overview_tile_is_visible(struct overview* ov, int tile)
+{
+	const int tx = (tile & ((1 << ov->tiles_log2)-1)) << ov->tile_log2;
+	const int ty = (tile >> ov->tiles_log2) << ov->tile_log2;
+	const int t = 1 << ov->tile_log2;
+	return tx+t > ov->view_x0 && tx < ov->view_x1 && ty+t > ov->view_y0 && ty < ov->view_y1;
+}
+
+// picks the next tile to load; call with the mutex held. returns -1 when
+// there are none left
+static int overview_pick_tile(struct overview* ov)
+{
+	const int n = 1 << (2*ov->tiles_log2);
+	const int t = 1 << ov->tile_log2;
+	const double cx = (ov->view_x0 + ov->view_x1) * 0.5;
+	const double cy = (ov->view_y0 + ov->view_y1) * 0.5;
+	int best = -1;
+	double best_dist = 0.0;
+	for (int i = 0; i < n; i++) {
+		if (ov->tile_state[i] != OVERVIEW_TILE_SAMPLED) continue;
+		const double dx = ((i & ((1 << ov->tiles_log2)-1)) + 0.5)*t - cx;
+		const double dy = ((i >> ov->tiles_log2) + 0.5)*t - cy;
+		const double dist = dx*dx + dy*dy;
+		if (best == -1 || dist < best_dist) {
+			best = i;
+			best_dist = dist;
+		}
+	}
+	return best;
+}
+
+// a tile that went out of view is given up if it's holding up visible ones
+static int overview_should_cancel(struct overview* ov, int tile)
+{
+	pthread_mutex_lock(&ov->mutex);
+	int cancel = 0;
+	if (!overview_tile_is_visible(ov, tile)) {
+		const int next = overview_pick_tile(ov);
+		cancel = next != -1 && overview_tile_is_visible(ov, next);
+	}
+	pthread_mutex_unlock(&ov->mutex);
+	return cancel;
+}
+
+// a pool job; the tile is picked when it starts. a job whose tile was
+// given up picks another, so there's one job per tile and none is missed
+static void overview_load_tile(void* usr, int job)
+{
+	struct overview* ov = usr;
+	const int tile_points_log2 = 2*ov->tile_log2;
+	const size_t block = (size_t)1 << (2*ov->level);
+	size_t chunk_points = (OVERVIEW_READ_CHUNK / N_COMP) / block * block;
+	if (chunk_points == 0) chunk_points = block;
+	uint8_t* buf = malloc(chunk_points * N_COMP);
+	uint8_t* reduced = malloc(((size_t)N_COMP << tile_points_log2));
+	uint64_t* ds = malloc(sizeof(uint64_t) << tile_points_log2);
+	uint32_t* xs = malloc(sizeof(uint32_t) << tile_points_log2);
+	uint32_t* ys = malloc(sizeof(uint32_t) << tile_points_log2);
+	assert(buf != NULL && reduced != NULL && ds != NULL && xs != NULL && ys != NULL);
+	for (;;) {
+		pthread_mutex_lock(&ov->mutex);
+		const int tile = overview_pick_tile(ov);
+		if (tile != -1) ov->tile_state[tile] = OVERVIEW_TILE_LOADING;
+		pthread_mutex_unlock(&ov->mutex);
+		if (tile == -1) break;
+
+		// the tile's overview points are a contiguous run of the input
+		const uint32_t tx = tile & ((1 << ov->tiles_log2)-1);
+		const uint32_t ty = tile >> ov->tiles_log2;
+		uint64_t tile_d;
+		uncurl_xy2d(ov->tiles_log2, 1, &tx, &ty, &tile_d);
+		const uint64_t d0 = tile_d << tile_points_log2;
+		const size_t n_ov = (size_t)1 << tile_points_log2;
+		memset(reduced, 0, N_COMP*n_ov);
+		const size_t p_begin = (size_t)d0 * block;
+		const size_t p_end = p_begin + n_ov*block < ov->n_points ? p_begin + n_ov*block : ov->n_points;
+		int is_cancelled = 0;
+		for (size_t p = p_begin; p < p_end; p += chunk_points) {
+			const size_t n = p_end - p < chunk_points ? p_end - p : chunk_points;
+			size_t got = 0;
+			while (got < n*N_COMP) {
+				const ssize_t r = pread(ov->fd, buf + got, n*N_COMP - got, (off_t)p*N_COMP + got);
+				if (r <= 0) break;
+				got += r;
+			}
+			memset(buf + got, 0, n*N_COMP - got);
+			uncurl_reduce(buf, n, ov->level, &reduced[(p - p_begin) / block * N_COMP]);
+			if (p + n < p_end && overview_should_cancel(ov, tile)) {
+				is_cancelled = 1;
+				break;
+			}
+		}
+		if (is_cancelled) {
+			pthread_mutex_lock(&ov->mutex);
+			ov->tile_state[tile] = OVERVIEW_TILE_SAMPLED;
+			pthread_mutex_unlock(&ov->mutex);
+			continue;
+		}
+
+		for (size_t i = 0; i < n_ov; i++) ds[i] = d0 + i;
+		uncurl_d2xy(ov->ov_width_log2, n_ov, ds, xs, ys);
+		const size_t n_valid = p_end > p_begin ? (p_end - p_begin + block - 1) / block : 0;
+		for (size_t i = 0; i < n_ov; i++) {
+			uint8_t* wp = &ov->image[(((size_t)ys[i] << ov->ov_width_log2) + xs[i])*N_COMP];
+			if (i < n_valid) {
+				memcpy(wp, &reduced[i*N_COMP], N_COMP);
+			} else {
+				memset(wp, 0, N_COMP);
+			}
+		}
+		pthread_mutex_lock(&ov->mutex);
+		ov->tile_state[tile] = OVERVIEW_TILE_DONE;
+		ov->dirty[tile] = 1;
+		ov->n_done++;
+		pthread_mutex_unlock(&ov->mutex);
+		break;
+	}
+	free(buf);
+	free(reduced);
+	free(ds);
+	free(xs);
+	free(ys);
+}
+
+// samples the input; the picture is ready when this returns. returns NULL
+// if the input can't be opened
+static struct overview* overview_open(const char* path)
+{
+	const int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		fprintf(stderr, "%s: could not open\n", path);
+		return NULL;
+	}
+	// st_size is 0 for block devices; seeking to the end works for both
+	const off_t size = lseek(fd, 0, SEEK_END);
+	if (size < N_COMP) {
+		fprintf(stderr, "%s: could not determine size (or too small)\n", path);
+		close(fd);
+		return NULL;
+	}
+	struct overview* ov = calloc(1, sizeof *ov);
+	assert(ov != NULL);
+	ov->fd = fd;
+	ov->n_points = size / N_COMP;
+	ov->width_log2 = uncurl_width_log2_for_length(ov->n_points);
+	ov->ov_width_log2 = ov->width_log2 < OVERVIEW_MAX_LOG2 ? ov->width_log2 : OVERVIEW_MAX_LOG2;
+	ov->level = ov->width_log2 - ov->ov_width_log2;
+	ov->tile_log2 = ov->ov_width_log2 < OVERVIEW_TILE_LOG2 ? ov->ov_width_log2 : OVERVIEW_TILE_LOG2;
+	ov->tiles_log2 = ov->ov_width_log2 - ov->tile_log2;
+	ov->image = malloc((size_t)N_COMP << (2*ov->ov_width_log2));
+	ov->tile_state = calloc(1 << (2*ov->tiles_log2), 1);
+	ov->dirty = calloc(1 << (2*ov->tiles_log2), 1);
+	assert(ov->image != NULL && ov->tile_state != NULL && ov->dirty != NULL);
+	ov->view_x1 = ov->view_y1 = 1 << ov->ov_width_log2;
+	pthread_mutex_init(&ov->mutex, NULL);
+
+	struct overview_sample_job sj = {
+		.ov = ov,
+		.sample_log2 = ov->ov_width_log2 < OVERVIEW_SAMPLE_LOG2 ? ov->ov_width_log2 : OVERVIEW_SAMPLE_LOG2,
+	};
+	uncurl_parallel_for(((1 << (2*sj.sample_log2)) + 255) / 256, overview_sample, &sj);
+	return ov;
+}
+
+// call once the sampled image has been uploaded
+static void overview_start_loading(struct overview* ov)
+{
+	// background priority, so panning and zooming (and whatever they
+	// need computed) go first
+	uncurl_batch_release(uncurl_submit(1 << (2*ov->tiles_log2), overview_load_tile, ov, UNCURL_PRIORITY_BACKGROUND));
+}
+
+// tells the workers what's on screen and uploads finished tiles. returns
+// the percentage done
+static int overview_update(struct overview* ov, SDL_Texture* texture)
+{
+	const int ow = 1 << ov->ov_width_log2;
+	const double s = (double)ow / (1 << ov->width_log2);
+	double lx0, ly0, lx1, ly1;
+	map_screen_to_local(0, 0, &lx0, &ly0);
+	map_screen_to_local(window_width, window_height, &lx1, &ly1);
+	const int n_tiles = 1 << (2*ov->tiles_log2);
+	uint8_t* dirty = malloc(n_tiles);
+	assert(dirty != NULL);
+	pthread_mutex_lock(&ov->mutex);
+	ov->view_x0 = floor(lx0*s + ow*0.5);
+	ov->view_y0 = floor(ly0*s + ow*0.5);
+	ov->view_x1 = ceil(lx1*s + ow*0.5);
+	ov->view_y1 = ceil(ly1*s + ow*0.5);
+	memcpy(dirty, ov->dirty, n_tiles);
+	memset(ov->dirty, 0, n_tiles);
+	const int n_done = ov->n_done;
+	pthread_mutex_unlock(&ov->mutex);
+	upload_tiles(texture, ov->image, ov->ov_width_log2, ov->tile_log2, dirty, NULL);
+	free(dirty);
+	return (int)((int64_t)n_done * 100 / n_tiles);
+}
+
+// maps a file (or block device) read-only; stdin is read into memory instead
+// returns NULL on errors
+static const uint8_t* map_file(const char* path, size_t* out_size)
+{
+	const int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		fprintf(stderr, "%s: could not open\n", path);
+		return NULL;
+	}
+	// st_size is 0 for block devices; seeking to the end works for both
+	const off_t size = lseek(fd, 0, SEEK_END);
+	if (size <= 0) {
+		fprintf(stderr, "%s: could not determine size (or empty)\n", path);
+		close(fd);
+		return NULL;
+	}
+	void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "%s: could not mmap\n", path);
+		return NULL;
+	}
+	*out_size = size;
+	return map;
+}
+
+static const uint8_t* map_entire_file(const char* path, size_t* out_size)
 {
-	FILE* in;
 	if (strcmp(path, "-") == 0) {
-		in = stdin;
+		const uint8_t* data = uncurl_read_entire_file(path, out_size);
+		if (data == NULL) {
+			fprintf(stderr, "%s: could not read\n", path);
+			exit(EXIT_FAILURE);
+		}
+		return data;
+	}
+	const uint8_t* map = map_file(path, out_size);
+	if (map == NULL) exit(EXIT_FAILURE);
+	return map;
+}
+
+// sliding-window scrubbing: the view shows a fixed-size window of a (possibly
+// huge) file at a moving offset. each step is a uncurl_rasterize() from the
+// mapped file on the pool, so the page faults land on the workers too, and
+// only the tiles the window covers are uploaded. windows are at most 3G, so
+// the image's side stays below 1<<16.
+
+#define SCRUB_TILE_LOG2 (6)
+#define SCRUB_SLIDER_HEIGHT (16)
+
+struct scrub {
+	const uint8_t* map;
+	size_t size;
+	size_t window;
+	size_t offset; // always a multiple of N_COMP
+	size_t readahead_begin, readahead_end;
+	double velocity; // bytes per second
+	size_t last_offset; // as of the last frame, for the velocity of drags
+};
+
+static void scrub_open(struct scrub* sc, const char* path, size_t window)
+{
+	memset(sc, 0, sizeof *sc);
+	sc->map = map_entire_file(path, &sc->size);
+	sc->size -= sc->size % N_COMP;
+	sc->window = window < sc->size ? window : sc->size;
+	sc->window -= sc->window % N_COMP;
+	if (sc->window == 0) {
+		fprintf(stderr, "%s: too small\n", path);
+		exit(EXIT_FAILURE);
+	}
+	if (uncurl_width_log2_for_length(sc->window / N_COMP) > 15) {
+		fprintf(stderr, "window:<SIZE> must be at most 3G\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static size_t scrub_max_offset(struct scrub* sc)
+{
+	return sc->size - sc->window;
+}
+
+static void scrub_set_offset(struct scrub* sc, double offset)
+{
+	const double max = scrub_max_offset(sc);
+	if (offset < 0.0) offset = 0.0;
+	if (offset > max) offset = max;
+	const size_t o = offset;
+	sc->offset = o - (o % N_COMP);
+}
+
+// asks the kernel to start reading what the next few steps in the scrub
+// direction will need, without blocking
+static void scrub_readahead(struct scrub* sc, double dt)
+{
+	if (sc->velocity == 0.0) return;
+	const size_t page = 1<<12;
+	double ahead = fabs(sc->velocity) * dt * 8.0;
+	if (ahead < (double)(1<<20)) ahead = 1<<20;
+	// a fast drag can move gigabytes a frame; it won't keep on for long
+	if (ahead > 4.0*(double)sc->window) ahead = 4.0*(double)sc->window;
+	size_t begin, end;
+	if (sc->velocity > 0.0) {
+		begin = sc->offset + sc->window;
+		end = begin + (size_t)ahead;
+	} else {
+		end = sc->offset;
+		begin = end > (size_t)ahead ? end - (size_t)ahead : 0;
+	}
+	if (end > sc->size) end = sc->size;
+	begin &= ~(page-1);
+	if (begin >= end) return;
+	// skip if it's mostly covered by the previous request
+	if (sc->readahead_begin <= begin && end <= sc->readahead_end) return;
+	madvise((void*)(sc->map + begin), end-begin, MADV_WILLNEED);
+	sc->readahead_begin = begin;
+	sc->readahead_end = end;
+}
+
+// the slider spans the whole window, not just a pane
+static void scrub_draw_slider(struct scrub* sc, SDL_Renderer* renderer, int width, int height)
+{
+	const int y = height - SCRUB_SLIDER_HEIGHT;
+	SDL_Rect bg = { .x = 0, .y = y, .w = width, .h = SCRUB_SLIDER_HEIGHT };
+	SDL_SetRenderDrawColor(renderer, 40, 40, 40, 255);
+	SDL_RenderFillRect(renderer, &bg);
+	const double f0 = (double)sc->offset / (double)sc->size;
+	const double f1 = (double)(sc->offset + sc->window) / (double)sc->size;
+	SDL_Rect knob = { .x = f0*width, .y = y, .h = SCRUB_SLIDER_HEIGHT };
+	knob.w = (f1-f0)*width;
+	if (knob.w < 4) knob.w = 4;
+	SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+	SDL_RenderFillRect(renderer, &knob);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
+
+static void scrub_slider_drag(struct scrub* sc, int mx, int width)
+{
+	const double f = (double)mx / (double)(width > 1 ? width : 1);
+	scrub_set_offset(sc, f * (double)sc->size - (double)sc->window * 0.5);
+}
+
+// hex labels on the cells when zoomed in far enough: the byte offset and
+// the RGB bytes of each visible cell, from a built-in 3x5 font in an atlas
+// texture, in a single SDL_RenderGeometry() call. the quads are kept until
+// the view or the content changes.
+
+#define LABEL_GLYPH_W (3)
+#define LABEL_GLYPH_H (5)
+
+// 0-9a-f; 5 rows of 3 bits, top row in the high bits
+static const uint16_t label_font[16] = {
+	0x7b6f, 0x2c97, 0x73e7, 0x72cf, 0x5bc9, 0x79cf, 0x79ef, 0x7249,
+	0x7bef, 0x7bcf, 0x7bed, 0x6bae, 0x7927, 0x6b6e, 0x79e7, 0x79e4,
+};
+
+struct labels {
+	SDL_Texture* atlas;
+	SDL_Vertex* vertices;
+	int* indices;
+	int n_quads, cap_quads;
+	// what the quads were made for
+	int is_valid;
+	SDL_Rect dst;
+	int window_width, window_height;
+	size_t content_version;
+};
+
+static void labels_init(struct labels* lb, SDL_Renderer* renderer)
+{
+	memset(lb, 0, sizeof *lb);
+	// glyphs in a row with a column of padding each
+	const int aw = 16*(LABEL_GLYPH_W+1);
+	uint32_t pixels[16*(LABEL_GLYPH_W+1)*LABEL_GLYPH_H] = {0};
+	for (int g = 0; g < 16; g++) {
+		for (int row = 0; row < LABEL_GLYPH_H; row++) {
+			for (int col = 0; col < LABEL_GLYPH_W; col++) {
+				const int bit = (LABEL_GLYPH_H-1-row)*LABEL_GLYPH_W + (LABEL_GLYPH_W-1-col);
+				if ((label_font[g] >> bit) & 1) pixels[row*aw + g*(LABEL_GLYPH_W+1) + col] = 0xffffffff;
+			}
+		}
+	}
+	lb->atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, aw, LABEL_GLYPH_H);
+	if (lb->atlas == NULL) SDL2FATAL();
+	SDL_UpdateTexture(lb->atlas, NULL, pixels, aw*sizeof pixels[0]);
+	SDL_SetTextureBlendMode(lb->atlas, SDL_BLENDMODE_BLEND);
+	SDL_SetTextureScaleMode(lb->atlas, SDL_ScaleModeNearest);
+}
+
+static void labels_add_glyph(struct labels* lb, int digit, float x, float y, float g, SDL_Color color)
+{
+	if (lb->n_quads >= lb->cap_quads) {
+		lb->cap_quads = lb->cap_quads ? lb->cap_quads*2 : 1<<12;
+		lb->vertices = realloc(lb->vertices, lb->cap_quads * 4 * sizeof lb->vertices[0]);
+		lb->indices = realloc(lb->indices, lb->cap_quads * 6 * sizeof lb->indices[0]);
+		assert(lb->vertices != NULL && lb->indices != NULL);
+	}
+	const float aw = 16*(LABEL_GLYPH_W+1);
+	const float u0 = digit*(LABEL_GLYPH_W+1) / aw;
+	const float u1 = (digit*(LABEL_GLYPH_W+1) + LABEL_GLYPH_W) / aw;
+	const float x1 = x + LABEL_GLYPH_W*g;
+	const float y1 = y + LABEL_GLYPH_H*g;
+	const int v = lb->n_quads*4;
+	SDL_Vertex* vp = &lb->vertices[v];
+	vp[0] = (SDL_Vertex) { {x,  y},  color, {u0, 0.0f} };
+	vp[1] = (SDL_Vertex) { {x1, y},  color, {u1, 0.0f} };
+	vp[2] = (SDL_Vertex) { {x1, y1}, color, {u1, 1.0f} };
+	vp[3] = (SDL_Vertex) { {x,  y1}, color, {u0, 1.0f} };
+	int* ip = &lb->indices[lb->n_quads*6];
+	ip[0] = v; ip[1] = v+1; ip[2] = v+2;
+	ip[3] = v; ip[4] = v+2; ip[5] = v+3;
+	lb->n_quads++;
+}
+
+// src is the data behind the image (point p's bytes are at src+p*N_COMP, for
+// p below n_points), and base_offset the byte offset of src in the input
+static void labels_draw(struct labels* lb, SDL_Renderer* renderer, SDL_Rect dst, int width_log2, size_t n_points, const uint8_t* src, size_t base_offset, int n_offset_digits, size_t content_version)
+{
+	const int is_same = lb->is_valid
+		&& memcmp(&dst, &lb->dst, sizeof dst) == 0
+		&& window_width == lb->window_width
+		&& window_height == lb->window_height
+		&& content_version == lb->content_version;
+	if (!is_same) {
+		lb->is_valid = 1;
+		lb->dst = dst;
+		lb->window_width = window_width;
+		lb->window_height = window_height;
+		lb->content_version = content_version;
+		lb->n_quads = 0;
+
+		const int width = 1<<width_log2;
+		const double cs = (double)dst.w / width; // cell size in screen pixels
+		const int n_max = n_offset_digits > 2*N_COMP ? n_offset_digits : 2*N_COMP;
+		const int g = (cs - 2.0) / (n_max*(LABEL_GLYPH_W+1));
+		if (g >= 1) {
+			int ix0 = floor(-dst.x / cs), ix1 = ceil((window_width - dst.x) / cs);
+			int iy0 = floor(-dst.y / cs), iy1 = ceil((window_height - dst.y) / cs);
+			if (ix0 < 0) ix0 = 0;
+			if (iy0 < 0) iy0 = 0;
+			if (ix1 > width) ix1 = width;
+			if (iy1 > width) iy1 = width;
+			for (int iy = iy0; iy < iy1; iy++) {
+				for (int ix = ix0; ix < ix1; ix++) {
+					// few cells are big enough for labels; no need to batch
+					const uint32_t x32 = ix, y32 = iy;
+					uint64_t p;
+					uncurl_xy2d(width_log2, 1, &x32, &y32, &p);
+					if (p >= n_points) continue;
+					const uint8_t* rgb = &src[(size_t)p*N_COMP];
+					const int luma = (rgb[0]*299 + rgb[1]*587 + rgb[2]*114) / 1000;
+					const SDL_Color color = luma > 128 ? (SDL_Color){0,0,0,255} : (SDL_Color){255,255,255,255};
+					const float x = dst.x + ix*cs + g;
+					const float y = dst.y + iy*cs + g;
+					const size_t offset = base_offset + (size_t)p*N_COMP;
+					for (int i = 0; i < n_offset_digits; i++) {
+						const int digit = (offset >> (4*(n_offset_digits-1-i))) & 0xf;
+						labels_add_glyph(lb, digit, x + i*(LABEL_GLYPH_W+1)*g, y, g, color);
+					}
+					for (int i = 0; i < 2*N_COMP; i++) {
+						const int digit = (rgb[i>>1] >> ((i&1) ? 0 : 4)) & 0xf;
+						labels_add_glyph(lb, digit, x + i*(LABEL_GLYPH_W+1)*g, y + (LABEL_GLYPH_H+1)*g, g, color);
+					}
+				}
+			}
+		}
+	}
+	if (lb->n_quads > 0) SDL_RenderGeometry(renderer, lb->atlas, lb->vertices, lb->n_quads*4, lb->indices, lb->n_quads*6);
+}
+
+// curve path overlay: a polyline through the centers of the visible cells
+// in curve order, made by descending the curve from the root and skipping
+// subtrees whose square is off screen. zoomed out, the descent stops at
+// blocks that are PATH_MIN_STEP pixels wide, so the cost follows what's on
+// screen, not the image size. kept until the view changes.
+
+#define PATH_MIN_STEP (8.0) // screen pixels between path points, at least
+
+struct path_overlay {
+	SDL_FPoint* points;
+	int n_points, cap_points;
+	int* run_ends; // the polyline is broken where it leaves the screen
+	int n_runs, cap_runs;
+	int is_valid;
+	SDL_Rect dst;
+	int window_width, window_height;
+};
+
+struct path_descent {
+	struct path_overlay* po;
+	int width_log2;
+	size_t n_points;
+	int stop_level;
+	double cs; // cell size in screen pixels
+	SDL_Rect dst;
+	// visible region in cells, grown by a block so lines run off screen
+	double x0, y0, x1, y1;
+};
+
+static void path_end_run(struct path_overlay* po)
+{
+	const int run_start = po->n_runs > 0 ? po->run_ends[po->n_runs-1] : 0;
+	if (po->n_points - run_start < 2) {
+		po->n_points = run_start;
+		return;
+	}
+	if (po->n_runs >= po->cap_runs) {
+		po->cap_runs = po->cap_runs ? po->cap_runs*2 : 64;
+		po->run_ends = realloc(po->run_ends, po->cap_runs * sizeof po->run_ends[0]);
+		assert(po->run_ends != NULL);
+	}
+	po->run_ends[po->n_runs++] = po->n_points;
+}
+
+// block is the index of an aligned run of 4^level points, which covers the
+// square at (bx,by) in units of 1<<level cells
+static void path_descend(struct path_descent* pd, uint64_t block, int level, uint32_t bx, uint32_t by)
+{
+	if ((block << (2*level)) >= pd->n_points) return;
+	const double size = (double)((uint64_t)1 << level);
+	const double x = bx*size, y = by*size;
+	if (x+size <= pd->x0 || x >= pd->x1 || y+size <= pd->y0 || y >= pd->y1) {
+		path_end_run(pd->po);
+		return;
+	}
+	if (level == pd->stop_level) {
+		struct path_overlay* po = pd->po;
+		if (po->n_points >= po->cap_points) {
+			po->cap_points = po->cap_points ? po->cap_points*2 : 1<<12;
+			po->points = realloc(po->points, po->cap_points * sizeof po->points[0]);
+			assert(po->points != NULL);
+		}
+		po->points[po->n_points++] = (SDL_FPoint) {
+			pd->dst.x + (x + size*0.5)*pd->cs,
+			pd->dst.y + (y + size*0.5)*pd->cs,
+		};
+		return;
+	}
+	// the children's squares, on the curve one level finer
+	uint64_t ds[4];
+	uint32_t xs[4], ys[4];
+	for (int q = 0; q < 4; q++) ds[q] = block*4 + q;
+	uncurl_d2xy(pd->width_log2 - (level-1), 4, ds, xs, ys);
+	for (int q = 0; q < 4; q++) path_descend(pd, ds[q], level-1, xs[q], ys[q]);
+}
+
+static void path_overlay_draw(struct path_overlay* po, SDL_Renderer* renderer, SDL_Rect dst, int width_log2, size_t n_points)
+{
+	const int is_same = po->is_valid
+		&& memcmp(&dst, &po->dst, sizeof dst) == 0
+		&& window_width == po->window_width
+		&& window_height == po->window_height;
+	if (!is_same) {
+		po->is_valid = 1;
+		po->dst = dst;
+		po->window_width = window_width;
+		po->window_height = window_height;
+		po->n_points = 0;
+		po->n_runs = 0;
+
+		struct path_descent pd = {
+			.po = po,
+			.width_log2 = width_log2,
+			.n_points = n_points,
+			.cs = (double)dst.w / ((uint64_t)1 << width_log2),
+			.dst = dst,
+		};
+		while (pd.stop_level < width_log2 && ((uint64_t)1 << pd.stop_level)*pd.cs < PATH_MIN_STEP) pd.stop_level++;
+		const double margin = (double)((uint64_t)1 << pd.stop_level);
+		pd.x0 = -dst.x / pd.cs - margin;
+		pd.y0 = -dst.y / pd.cs - margin;
+		pd.x1 = (window_width - dst.x) / pd.cs + margin;
+		pd.y1 = (window_height - dst.y) / pd.cs + margin;
+		path_descend(&pd, 0, width_log2, 0, 0);
+		path_end_run(po);
+	}
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 255, 64, 255, 200);
+	int run_start = 0;
+	for (int i = 0; i < po->n_runs; i++) {
+		SDL_RenderDrawLinesF(renderer, &po->points[run_start], po->run_ends[i] - run_start);
+		run_start = po->run_ends[i];
+	}
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
+
+// a range of points along the curve is a run of aligned blocks of 4^k
+// points, each of which fills a 2^k square; there are at most 3 per level
+// on either side
+#define CURVE_MAX_SQUARES (6*32)
+
+struct curve_square {
+	int x, y, size;
+};
+
+static int curve_range_squares(int width_log2, uint64_t begin, uint64_t end, struct curve_square* out)
+{
+	int n = 0;
+	while (begin < end) {
+		int k = 0;
+		while (k < width_log2 && (begin & ((4ull << (2*k)) - 1)) == 0 && begin + (4ull << (2*k)) <= end) k++;
+		assert(n < CURVE_MAX_SQUARES);
+		const uint64_t block = begin >> (2*k);
+		uint32_t x, y;
+		uncurl_d2xy(width_log2 - k, 1, &block, &x, &y);
+		out[n++] = (struct curve_square){ .x = x << k, .y = y << k, .size = 1 << k };
+		begin += 1ull << (2*k);
+	}
+	return n;
+}
+
+// fills the squares of points [begin;end) on the image drawn at dst with
+// the current draw color
+static void curve_range_fill(SDL_Renderer* renderer, SDL_Rect dst, int width_log2, uint64_t begin, uint64_t end)
+{
+	struct curve_square sq[CURVE_MAX_SQUARES];
+	const int n = curve_range_squares(width_log2, begin, end, sq);
+	const double cs = (double)dst.w / (1 << width_log2);
+	for (int i = 0; i < n; i++) {
+		const SDL_FRect r = { dst.x + sq[i].x*cs, dst.y + sq[i].y*cs, sq[i].size*cs, sq[i].size*cs };
+		SDL_RenderFillRectF(renderer, &r);
+	}
+}
+
+// control:<PATH> listens on a Unix socket for commands, so that scripts can
+// drive a resident viewer rather than start a new one per file. a command
+// is a line of text and gets a single line reply starting with "ok" or
+// "error". they're read between frames, so they apply on the next:
+//   open <input>             view another input (kept loaded afterwards).
+//                            new ones load in the background, one at a
+//                            time: the reply is "ok loading" and the view
+//                            switches once it's loaded. repeat the command
+//                            to poll; it replies "ok <size>" when switched,
+//                            or the error if the load failed
+//   goto <offset>            center the view on a byte offset
+//   zoom <begin> <end>       fit the byte range [begin;end) to the window
+//   highlight <begin> <end>  mark a byte range; "highlight clear" unmarks
+//   find <query>             tint the values a query matches, as with
+//                            find:<QUERY>; "find clear" stops
+//   find                     reply with the hits, in all and in view of
+//                            each pane (as last drawn)
+//   query                    reply with input, size, zoom and the offset at
+//                            the window center
+//   query <offset>           reply with the pixel a byte offset is drawn at
+// offsets are decimal or 0x-prefixed hex, and count like click coordinates
+// do (relative to the frame in frames:<SIZE> mode).
+
+#define CONTROL_MAX_CLIENTS (16)
+#define CONTROL_LINE_MAX (1<<12)
+#define CONTROL_MAX_PER_FRAME (64) // so a chatty client can't stall drawing
+
+struct control_client {
+	int fd;
+	int n, n_consumed;
+	int is_skipping; // the rest of an overlong line
+	char line[CONTROL_LINE_MAX];
+};
+
+struct control {
+	int fd;
+	int n_clients;
+	struct control_client clients[CONTROL_MAX_CLIENTS];
+};
+
+static void control_open(struct control* ctl, const char* path)
+{
+	memset(ctl, 0, sizeof *ctl);
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	if (strlen(path) >= sizeof addr.sun_path) {
+		fprintf(stderr, "%s: socket path too long\n", path);
+		exit(EXIT_FAILURE);
+	}
+	strcpy(addr.sun_path, path);
+	// replace a socket left behind by an earlier run, but nothing else
+	struct stat st;
+	if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+	ctl->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (ctl->fd == -1 || bind(ctl->fd, (struct sockaddr*)&addr, sizeof addr) == -1 || listen(ctl->fd, CONTROL_MAX_CLIENTS) == -1) {
+		fprintf(stderr, "%s: could not listen: %s\n", path, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void control_reply(struct control* ctl, int client, const char* fmt, ...)
+{
+	char buf[1<<13];
+	va_list ap;
+	va_start(ap, fmt);
+	int n = vsnprintf(buf, sizeof buf - 1, fmt, ap);
+	va_end(ap);
+	if (n > (int)sizeof buf - 2) n = sizeof buf - 2;
+	buf[n++] = '\n';
+	// replies are short; a client that doesn't read them loses them
+	(void)send(ctl->clients[client].fd, buf, n, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+// returns the next complete command line, or NULL if there are none. the
+// line stays valid (and out_client names its sender) until the next call
+static char* control_next(struct control* ctl, int* out_client)
+{
+	for (;;) {
+		const int fd = accept4(ctl->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd == -1) break;
+		if (ctl->n_clients == CONTROL_MAX_CLIENTS) {
+			close(fd);
+			continue;
+		}
+		struct control_client* c = &ctl->clients[ctl->n_clients++];
+		c->fd = fd;
+		c->n = c->n_consumed = c->is_skipping = 0;
+	}
+	for (int i = 0; i < ctl->n_clients; i++) {
+		struct control_client* c = &ctl->clients[i];
+		if (c->n_consumed > 0) {
+			c->n -= c->n_consumed;
+			memmove(c->line, c->line + c->n_consumed, c->n);
+			c->n_consumed = 0;
+		}
+		char* nl = memchr(c->line, '\n', c->n);
+		if (nl == NULL && c->n < CONTROL_LINE_MAX) {
+			const ssize_t n = recv(c->fd, c->line + c->n, CONTROL_LINE_MAX - c->n, MSG_DONTWAIT);
+			if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+				close(c->fd);
+				*c = ctl->clients[--ctl->n_clients];
+				i--;
+				continue;
+			}
+			if (n > 0) {
+				c->n += n;
+				nl = memchr(c->line, '\n', c->n);
+			}
+		}
+		if (nl == NULL && c->n == CONTROL_LINE_MAX) {
+			if (!c->is_skipping) control_reply(ctl, i, "error line too long");
+			c->is_skipping = 1;
+			c->n = 0;
+			continue;
+		}
+		if (nl == NULL) continue;
+		if (c->is_skipping) {
+			c->is_skipping = 0;
+			c->n_consumed = nl - c->line + 1;
+			i--;
+			continue;
+		}
+		*nl = 0;
+		if (nl > c->line && nl[-1] == '\r') nl[-1] = 0;
+		c->n_consumed = nl - c->line + 1;
+		*out_client = i;
+		return c->line;
+	}
+	return NULL;
+}
+
+// maps byte range [begin;end) to the points of it that are on the image,
+// which starts at byte offset base and has point_size bytes of input per
+// point. returns 0 if there are none
+static int control_range_points(uint64_t begin, uint64_t end, size_t base, size_t point_size, size_t n_points, uint64_t* out_begin, uint64_t* out_end)
+{
+	begin = begin > base ? begin - base : 0;
+	end = end > base ? end - base : 0;
+	*out_begin = begin / point_size;
+	*out_end = (end + point_size-1) / point_size;
+	if (*out_end > n_points) *out_end = n_points;
+	return *out_begin < *out_end;
+}
+
+// parses "<offset>" or "<begin> <end>" into byte offsets; returns the
+// number parsed
+static int control_parse_offsets(const char* s, unsigned long long* out, int n_max)
+{
+	int n = 0;
+	while (n < n_max) {
+		while (*s == ' ') s++;
+		if (*s == 0) break;
+		if (*s == '-') return -1;
+		char* end;
+		errno = 0;
+		out[n++] = strtoull(s, &end, 0);
+		if (end == s || errno != 0 || (*end != ' ' && *end != 0)) return -1;
+		s = end;
+	}
+	while (*s == ' ') s++;
+	return *s == 0 ? n : -1;
+}
+
+// ELF inputs (executables, core dumps, kernel images) are recognized by
+// their program and section headers, which are read with pread() at load;
+// only the headers, so a multi-GB core opens as fast as anything else.
+// clicks then also report the file offset, virtual address and section (or
+// segment type), found by binary search in tables sorted by file offset.
+// E toggles an overlay of the loadable segments, colored by permission.
+
+#define ELF_MAX_TABLE (1<<26) // bytes of program or section headers
+
+struct elf_region {
+	uint64_t offset, size; // in the file
+	uint64_t vaddr;
+	uint32_t type; // PT_* or SHT_*
+	uint32_t flags; // PF_* for segments
+	const char* name; // for sections
+	uint64_t reach; // furthest end of this and the regions before it
+};
+
+struct elf_square {
+	struct curve_square sq;
+	int class; // ELF_CLASS_*
+};
+
+enum {
+	ELF_CLASS_EXEC = 0,
+	ELF_CLASS_WRITE,
+	ELF_CLASS_READ,
+	ELF_N_CLASSES,
+};
+
+struct elf_map {
+	struct elf_region* segments; // PT_LOAD and PT_NOTE
+	int n_segments;
+	struct elf_region* sections; // those with contents in the file
+	int n_sections;
+	char* names;
+	int is_64, is_be;
+	// overlay squares, for the image starting at byte base
+	int is_valid;
+	size_t base;
+	int width_log2;
+	struct elf_square* squares;
+	int n_squares, cap_squares;
+};
+
+struct elf_reader {
+	int fd;
+	int is_64, is_be;
+};
+
+static uint64_t elf_get(const struct elf_reader* rd, const uint8_t* p, size_t size)
+{
+	uint64_t v = 0;
+	for (size_t i = 0; i < size; i++) v |= (uint64_t)p[rd->is_be ? size-1-i : i] << (8*i);
+	return v;
+}
+
+// reads field f of header type T (Ehdr, Phdr, Shdr) from the raw header at p
+#define ELF_GET(rd, p, T, f) ((rd)->is_64 \
+	? elf_get((rd), (p) + offsetof(Elf64_ ## T, f), sizeof(((Elf64_ ## T*)0)->f)) \
+	: elf_get((rd), (p) + offsetof(Elf32_ ## T, f), sizeof(((Elf32_ ## T*)0)->f)))
+
+static uint8_t* elf_read(const struct elf_reader* rd, uint64_t offset, size_t size)
+{
+	uint8_t* buf = malloc(size + 1);
+	assert(buf != NULL);
+	if (pread(rd->fd, buf, size, (off_t)offset) != (ssize_t)size) {
+		free(buf);
+		return NULL;
+	}
+	buf[size] = 0;
+	return buf;
+}
+
+static int elf_region_compare(const void* va, const void* vb)
+{
+	const struct elf_region* a = va;
+	const struct elf_region* b = vb;
+	return a->offset < b->offset ? -1 : a->offset > b->offset ? 1 : 0;
+}
+
+static void elf_regions_sort(struct elf_region* rs, int n)
+{
+	qsort(rs, n, sizeof *rs, elf_region_compare);
+	uint64_t reach = 0;
+	for (int i = 0; i < n; i++) {
+		const uint64_t end = rs[i].offset + rs[i].size;
+		if (end > reach) reach = end;
+		rs[i].reach = reach;
+	}
+}
+
+// returns NULL if path isn't an ELF file
+static struct elf_map* elf_open(const char* path)
+{
+	struct elf_reader rd = { .fd = open(path, O_RDONLY) };
+	if (rd.fd == -1) return NULL;
+	struct elf_map* em = NULL;
+	uint8_t ehdr[sizeof(Elf64_Ehdr)];
+	uint8_t* phdrs = NULL;
+	uint8_t* shdrs = NULL;
+	if (pread(rd.fd, ehdr, EI_NIDENT, 0) != EI_NIDENT || memcmp(ehdr, ELFMAG, SELFMAG) != 0) goto done;
+	if (ehdr[EI_CLASS] != ELFCLASS32 && ehdr[EI_CLASS] != ELFCLASS64) goto done;
+	if (ehdr[EI_DATA] != ELFDATA2LSB && ehdr[EI_DATA] != ELFDATA2MSB) goto done;
+	rd.is_64 = (ehdr[EI_CLASS] == ELFCLASS64);
+	rd.is_be = (ehdr[EI_DATA] == ELFDATA2MSB);
+	const size_t ehdr_size = rd.is_64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr);
+	if (pread(rd.fd, ehdr, ehdr_size, 0) != (ssize_t)ehdr_size) goto done;
+
+	em = calloc(1, sizeof *em);
+	assert(em != NULL);
+	em->is_64 = rd.is_64;
+	em->is_be = rd.is_be;
+	const uint64_t phoff = ELF_GET(&rd, ehdr, Ehdr, e_phoff);
+	const uint64_t shoff = ELF_GET(&rd, ehdr, Ehdr, e_shoff);
+	const size_t phentsize = ELF_GET(&rd, ehdr, Ehdr, e_phentsize);
+	const size_t shentsize = ELF_GET(&rd, ehdr, Ehdr, e_shentsize);
+	size_t phnum = ELF_GET(&rd, ehdr, Ehdr, e_phnum);
+	size_t shnum = ELF_GET(&rd, ehdr, Ehdr, e_shnum);
+	size_t shstrndx = ELF_GET(&rd, ehdr, Ehdr, e_shstrndx);
+	const size_t min_phentsize = rd.is_64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr);
+	const size_t min_shentsize = rd.is_64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr);
+
+	// counts that don't fit the ELF header are in the first section header
+	if (shoff != 0 && shentsize >= min_shentsize && (phnum == PN_XNUM || shnum == 0 || shstrndx == SHN_XINDEX)) {
+		uint8_t* sh0 = elf_read(&rd, shoff, shentsize);
+		if (sh0 != NULL) {
+			if (phnum == PN_XNUM) phnum = ELF_GET(&rd, sh0, Shdr, sh_info);
+			if (shnum == 0) shnum = ELF_GET(&rd, sh0, Shdr, sh_size);
+			if (shstrndx == SHN_XINDEX) shstrndx = ELF_GET(&rd, sh0, Shdr, sh_link);
+			free(sh0);
+		}
+	}
+
+	if (phoff != 0 && phentsize >= min_phentsize && phnum > 0 && phnum*phentsize <= ELF_MAX_TABLE) {
+		phdrs = elf_read(&rd, phoff, phnum*phentsize);
+	}
+	if (phdrs != NULL) {
+		em->segments = calloc(phnum, sizeof *em->segments);
+		assert(em->segments != NULL);
+		for (size_t i = 0; i < phnum; i++) {
+			const uint8_t* p = phdrs + i*phentsize;
+			const uint32_t type = ELF_GET(&rd, p, Phdr, p_type);
+			const uint64_t size = ELF_GET(&rd, p, Phdr, p_filesz);
+			if ((type != PT_LOAD && type != PT_NOTE) || size == 0) continue;
+			em->segments[em->n_segments++] = (struct elf_region){
+				.offset = ELF_GET(&rd, p, Phdr, p_offset),
+				.size = size,
+				.vaddr = ELF_GET(&rd, p, Phdr, p_vaddr),
+				.type = type,
+				.flags = ELF_GET(&rd, p, Phdr, p_flags),
+			};
+		}
+		elf_regions_sort(em->segments, em->n_segments);
+	}
+
+	if (shoff != 0 && shentsize >= min_shentsize && shnum > 0 && shnum*shentsize <= ELF_MAX_TABLE) {
+		shdrs = elf_read(&rd, shoff, shnum*shentsize);
+	}
+	if (shdrs != NULL) {
+		if (shstrndx < shnum) {
+			const uint8_t* p = shdrs + shstrndx*shentsize;
+			const uint64_t size = ELF_GET(&rd, p, Shdr, sh_size);
+			if (size < ((uint64_t)1 << 30)) em->names = (char*)elf_read(&rd, ELF_GET(&rd, p, Shdr, sh_offset), size);
+		}
+		const size_t names_size = em->names != NULL ? ELF_GET(&rd, shdrs + shstrndx*shentsize, Shdr, sh_size) : 0;
+		em->sections = calloc(shnum, sizeof *em->sections);
+		assert(em->sections != NULL);
+		for (size_t i = 1; i < shnum; i++) {
+			const uint8_t* p = shdrs + i*shentsize;
+			const uint32_t type = ELF_GET(&rd, p, Shdr, sh_type);
+			const uint64_t size = ELF_GET(&rd, p, Shdr, sh_size);
+			if (type == SHT_NOBITS || type == SHT_NULL || size == 0) continue;
+			const size_t name = ELF_GET(&rd, p, Shdr, sh_name);
+			em->sections[em->n_sections++] = (struct elf_region){
+				.offset = ELF_GET(&rd, p, Shdr, sh_offset),
+				.size = size,
+				.vaddr = ELF_GET(&rd, p, Shdr, sh_addr),
+				.type = type,
+				.name = name < names_size ? em->names + name : "?",
+			};
+		}
+		elf_regions_sort(em->sections, em->n_sections);
+	}
+done:
+	free(phdrs);
+	free(shdrs);
+	close(rd.fd);
+	return em;
+}
+
+// returns the innermost region containing a file offset, or NULL. regions
+// may nest (a note inside a loadable segment), so the search steps back
+// until none before could reach the offset
+static const struct elf_region* elf_find(const struct elf_region* rs, int n, uint64_t offset)
+{
+	int lo = 0, hi = n;
+	while (lo < hi) {
+		const int mid = lo + (hi - lo) / 2;
+		if (rs[mid].offset <= offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	for (int i = lo-1; i >= 0 && rs[i].reach > offset; i--) {
+		if (offset - rs[i].offset < rs[i].size) return &rs[i];
+	}
+	return NULL;
+}
+
+// "<file offset>\t<virtual address>\t<section>", with "-" for unknowns
+static void elf_describe(const struct elf_map* em, uint64_t offset, char* buf, size_t size)
+{
+	const struct elf_region* seg = elf_find(em->segments, em->n_segments, offset);
+	const struct elf_region* sec = elf_find(em->sections, em->n_sections, offset);
+	char vaddr[32] = "-";
+	if (seg != NULL && seg->type == PT_LOAD) {
+		snprintf(vaddr, sizeof vaddr, "0x%llx", (unsigned long long)(seg->vaddr + (offset - seg->offset)));
+	} else if (sec != NULL && sec->vaddr != 0) {
+		snprintf(vaddr, sizeof vaddr, "0x%llx", (unsigned long long)(sec->vaddr + (offset - sec->offset)));
+	}
+	const char* where = sec != NULL ? sec->name : seg != NULL ? (seg->type == PT_NOTE ? "PT_NOTE" : "PT_LOAD") : "-";
+	snprintf(buf, size, "0x%llx\t%s\t%s", (unsigned long long)offset, vaddr, where);
+}
+
+static void elf_draw(struct elf_map* em, SDL_Renderer* renderer, SDL_Rect dst, int width_log2, size_t base, size_t point_size, size_t n_points)
+{
+	if (!em->is_valid || em->base != base || em->width_log2 != width_log2) {
+		em->is_valid = 1;
+		em->base = base;
+		em->width_log2 = width_log2;
+		em->n_squares = 0;
+		for (int i = 0; i < em->n_segments; i++) {
+			const struct elf_region* r = &em->segments[i];
+			if (r->type != PT_LOAD) continue;
+			uint64_t b, e;
+			if (!control_range_points(r->offset, r->offset + r->size, base, point_size, n_points, &b, &e)) continue;
+			if (em->n_squares + CURVE_MAX_SQUARES > em->cap_squares) {
+				em->cap_squares = 2*em->cap_squares + CURVE_MAX_SQUARES;
+				em->squares = realloc(em->squares, em->cap_squares * sizeof *em->squares);
+				assert(em->squares != NULL);
+			}
+			struct curve_square sq[CURVE_MAX_SQUARES];
+			const int n = curve_range_squares(width_log2, b, e, sq);
+			const int class = (r->flags & PF_X) ? ELF_CLASS_EXEC : (r->flags & PF_W) ? ELF_CLASS_WRITE : ELF_CLASS_READ;
+			for (int j = 0; j < n; j++) em->squares[em->n_squares++] = (struct elf_square){ .sq = sq[j], .class = class };
+		}
+	}
+
+	static const uint8_t colors[ELF_N_CLASSES][3] = { {255,60,60}, {60,255,60}, {60,120,255} };
+	const double cs = (double)dst.w / (1 << width_log2);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	for (int class = 0; class < ELF_N_CLASSES; class++) {
+		SDL_SetRenderDrawColor(renderer, colors[class][0], colors[class][1], colors[class][2], 48);
+		SDL_FRect rects[256];
+		int n_rects = 0;
+		for (int i = 0; i < em->n_squares; i++) {
+			const struct elf_square* s = &em->squares[i];
+			if (s->class != class) continue;
+			const SDL_FRect r = { dst.x + s->sq.x*cs, dst.y + s->sq.y*cs, s->sq.size*cs, s->sq.size*cs };
+			// sub-pixel bits of the edges aren't worth the overdraw
+			if (r.w < 0.5f) continue;
+			if (r.x + r.w < 0 || r.y + r.h < 0 || r.x > window_width || r.y > window_height) continue;
+			rects[n_rects++] = r;
+			if (n_rects == ARRAY_LENGTH(rects)) {
+				SDL_RenderFillRectsF(renderer, rects, n_rects);
+				n_rects = 0;
+			}
+		}
+		if (n_rects > 0) SDL_RenderFillRectsF(renderer, rects, n_rects);
+	}
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
+
+// pointer overlay for memory dumps (pointers, or pointers:<ADDR> for a raw
+// little-endian dump of memory starting at ADDR): a background job scans
+// the input for words that point into it (see uncurl_pointer_graph_new()),
+// with the address ranges taken from the loadable segments of an ELF core.
+// once it's done, lines go from the cells under the cursor and in the
+// selection to what they point at. G toggles.
+#define POINTERS_MAX_EDGES (1<<12) // drawn per frame
+
+struct byte_range {
+	uint64_t begin, end;
+};
+
+struct pointers {
+	char* path;
+	struct uncurl_address_range* ranges;
+	int n_ranges;
+	int is_be;
+	struct uncurl_batch* batch; // the scan; NULL once it's done
+	struct uncurl_pointer_graph* graph; // NULL until then
+	struct uncurl_edge* edges;
+	uint64_t* ds; // sources then targets, as points
+	uint32_t *xs, *ys;
+};
+
+static void pointers_scan(void* usr, int job)
+{
+	struct pointers* pt = usr;
+	size_t size;
+	const uint8_t* map = map_file(pt->path, &size);
+	if (map == NULL) return;
+	madvise((void*)map, size, MADV_SEQUENTIAL);
+	pt->graph = uncurl_pointer_graph_new(map, size, pt->ranges, pt->n_ranges, pt->is_be);
+	munmap((void*)map, size);
+}
+
+// starts the scan; em is the input's ELF map or NULL. returns NULL (with a
+// message) if there are no address ranges to go by
+static struct pointers* pointers_open(const char* path, const struct elf_map* em, int has_base, uint64_t base)
+{
+	struct pointers* pt = calloc(1, sizeof *pt);
+	assert(pt != NULL);
+	if (has_base) {
+		const int fd = open(path, O_RDONLY);
+		const off_t size = fd != -1 ? lseek(fd, 0, SEEK_END) : -1;
+		if (fd != -1) close(fd);
+		if (size <= 0) {
+			fprintf(stderr, "%s: could not open (or empty)\n", path);
+			free(pt);
+			return NULL;
+		}
+		pt->ranges = malloc(sizeof *pt->ranges);
+		assert(pt->ranges != NULL);
+		pt->ranges[pt->n_ranges++] = (struct uncurl_address_range){ .vaddr = base, .size = size, .offset = 0 };
+	} else if (em != NULL && em->is_64) {
+		pt->ranges = calloc(em->n_segments + 1, sizeof *pt->ranges);
+		assert(pt->ranges != NULL);
+		for (int i = 0; i < em->n_segments; i++) {
+			const struct elf_region* r = &em->segments[i];
+			if (r->type != PT_LOAD) continue;
+			pt->ranges[pt->n_ranges++] = (struct uncurl_address_range){ .vaddr = r->vaddr, .size = r->size, .offset = r->offset };
+		}
+		pt->is_be = em->is_be;
+	} else {
+		fprintf(stderr, "%s: pointers needs a 64-bit ELF core; use pointers:<ADDR> for raw dumps\n", path);
+		free(pt);
+		return NULL;
+	}
+	pt->path = strdup(path);
+	pt->edges = malloc(POINTERS_MAX_EDGES * sizeof *pt->edges);
+	pt->ds = malloc(2*POINTERS_MAX_EDGES * sizeof *pt->ds);
+	pt->xs = malloc(2*POINTERS_MAX_EDGES * sizeof *pt->xs);
+	pt->ys = malloc(2*POINTERS_MAX_EDGES * sizeof *pt->ys);
+	assert(pt->path != NULL && pt->edges != NULL && pt->ds != NULL && pt->xs != NULL && pt->ys != NULL);
+	pt->batch = uncurl_submit(1, pointers_scan, pt, UNCURL_PRIORITY_BACKGROUND);
+	return pt;
+}
+
+// draws the edges out of the byte ranges qs (on the image starting at byte
+// base) whose ends are both on it
+static void pointers_draw(struct pointers* pt, SDL_Renderer* renderer, SDL_Rect dst, int width_log2, size_t base, size_t point_size, size_t n_points, const struct byte_range* qs, int n_qs)
+{
+	if (pt->batch != NULL && uncurl_batch_is_done(pt->batch)) {
+		uncurl_batch_release(pt->batch);
+		pt->batch = NULL;
+	}
+	if (pt->graph == NULL) return;
+	int n = 0;
+	for (int q = 0; q < n_qs && n < POINTERS_MAX_EDGES; q++) {
+		const size_t n_found = uncurl_pointer_graph_find(pt->graph, qs[q].begin, qs[q].end, pt->edges, POINTERS_MAX_EDGES - n);
+		for (size_t i = 0; i < n_found; i++) {
+			uint64_t sb, tb, e;
+			if (!control_range_points(pt->edges[i].source, pt->edges[i].source + 1, base, point_size, n_points, &sb, &e)) continue;
+			if (!control_range_points(pt->edges[i].target, pt->edges[i].target + 1, base, point_size, n_points, &tb, &e)) continue;
+			pt->ds[n] = sb;
+			pt->ds[POINTERS_MAX_EDGES + n] = tb;
+			n++;
+		}
+	}
+	if (n == 0) return;
+	memmove(&pt->ds[n], &pt->ds[POINTERS_MAX_EDGES], n * sizeof pt->ds[0]);
+	uncurl_d2xy(width_log2, 2*n, pt->ds, pt->xs, pt->ys);
+
+	const double cs = (double)dst.w / (1 << width_log2);
+	const float mark = cs > 3.0 ? cs : 3.0;
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 255, 160, 0, 192);
+	for (int i = 0; i < n; i++) {
+		const float x0 = dst.x + (pt->xs[i] + 0.5)*cs, y0 = dst.y + (pt->ys[i] + 0.5)*cs;
+		const float x1 = dst.x + (pt->xs[n+i] + 0.5)*cs, y1 = dst.y + (pt->ys[n+i] + 0.5)*cs;
+		SDL_RenderDrawLineF(renderer, x0, y0, x1, y1);
+		const SDL_FRect r = { x1 - mark*0.5f, y1 - mark*0.5f, mark, mark };
+		SDL_RenderDrawRectF(renderer, &r);
+	}
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
+
+// strings (or strings:<MIN> for a minimum length other than 4): runs of
+// printable characters are found in the background, like strings(1) would
+// (see uncurl_strings_find()). hovering over one shows it in the title,
+// clicks write it out too, and an overlay tints the cells by how much of
+// them is strings; T toggles it. the overlay descends the curve like the
+// path overlay does, but doesn't split blocks that are all or nothing
+// strings; a block's coverage is two binary searches into a prefix sum of
+// the string lengths.
+#define STRINGS_DEFAULT_MIN (4)
+#define STRINGS_MIN_STEP (2.0) // screen pixels per overlay block, at least
+#define STRINGS_SHOW_MAX (200) // characters of a string shown or written
+
+struct strings {
+	char* path;
+	int fd; // for the text when the data isn't at hand; -1 otherwise
+	const uint8_t* data; // NULL: map path for the scan
+	size_t size, min_length;
+	struct uncurl_batch* batch; // the scan; NULL once it's done
+	struct uncurl_string* runs; // NULL until then
+	size_t n_runs;
+	uint64_t* covered; // bytes in strings before each run, and in all
+	size_t version; // bumped when the scan is done
+};
+
+struct strings_overlay {
+	SDL_Vertex* vertices;
+	int* indices;
+	int n_quads, cap_quads;
+	// what the quads were made for
+	int is_valid;
+	SDL_Rect dst;
+	int window_width, window_height;
+	size_t base, version;
+};
+
+struct strings_descent {
+	const struct strings* st;
+	struct strings_overlay* so;
+	int width_log2;
+	size_t n_points, base, point_size;
+	int stop_level;
+	double cs; // cell size in screen pixels
+	SDL_Rect dst;
+	double x0, y0, x1, y1; // visible region in cells
+};
+
+static void strings_scan(void* usr, int job)
+{
+	struct strings* st = usr;
+	size_t size = st->size;
+	const uint8_t* data = st->data != NULL ? st->data : map_file(st->path, &size);
+	if (data == NULL) return;
+	size_t n_runs;
+	struct uncurl_string* runs = uncurl_strings_find(data, size, st->min_length, &n_runs);
+	if (st->data == NULL) munmap((void*)data, size);
+	if (runs == NULL) {
+		fprintf(stderr, "%s: out of memory finding strings\n", st->path);
+		return;
+	}
+	st->n_runs = n_runs;
+	st->covered = malloc((st->n_runs + 1) * sizeof st->covered[0]);
+	assert(st->covered != NULL);
+	uint64_t sum = 0;
+	for (size_t i = 0; i < st->n_runs; i++) {
+		st->covered[i] = sum;
+		sum += runs[i].length;
+	}
+	st->covered[st->n_runs] = sum;
+	st->runs = runs;
+}
+
+// scans data, or the file at path if data is NULL
+static struct strings* strings_open(const char* path, const uint8_t* data, size_t size, size_t min_length)
+{
+	struct strings* st = calloc(1, sizeof *st);
+	assert(st != NULL);
+	st->path = strdup(path);
+	assert(st->path != NULL);
+	st->fd = data == NULL ? open(path, O_RDONLY) : -1;
+	st->data = data;
+	st->size = size;
+	st->min_length = min_length;
+	st->batch = uncurl_submit(1, strings_scan, st, UNCURL_PRIORITY_BACKGROUND);
+	return st;
+}
+
+// returns 1 once the scan is done
+static int strings_update(struct strings* st)
+{
+	if (st->batch != NULL && uncurl_batch_is_done(st->batch)) {
+		uncurl_batch_release(st->batch);
+		st->batch = NULL;
+		st->version++;
+	}
+	return st->batch == NULL && st->runs != NULL;
+}
+
+// index of the string containing a byte offset, or -1
+static int64_t strings_find(const struct strings* st, uint64_t offset)
+{
+	size_t lo = 0, hi = st->n_runs;
+	while (lo < hi) {
+		const size_t mid = (lo+hi) >> 1;
+		if (st->runs[mid].offset <= offset) {
+			lo = mid+1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == 0) return -1;
+	const struct uncurl_string* r = &st->runs[lo-1];
+	return offset - r->offset < r->length ? (int64_t)(lo-1) : -1;
+}
+
+// bytes in strings before a byte offset
+static uint64_t strings_covered(const struct strings* st, uint64_t offset)
+{
+	size_t lo = 0, hi = st->n_runs;
+	while (lo < hi) {
+		const size_t mid = (lo+hi) >> 1;
+		if (st->runs[mid].offset < offset) {
+			lo = mid+1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == 0) return 0;
+	const struct uncurl_string* r = &st->runs[lo-1];
+	const uint64_t in = offset - r->offset;
+	return st->covered[lo-1] + (in < r->length ? in : r->length);
+}
+
+// the text of string i, shortened to STRINGS_SHOW_MAX characters, with tabs
+// as spaces so it can go in a tab separated line
+static void strings_text(const struct strings* st, int64_t i, char* buf, size_t size)
+{
+	const struct uncurl_string* r = &st->runs[i];
+	char text[STRINGS_SHOW_MAX + 1];
+	const size_t n = r->length < STRINGS_SHOW_MAX ? r->length : STRINGS_SHOW_MAX;
+	if (st->data != NULL) {
+		memcpy(text, st->data + r->offset, n);
+	} else if (st->fd == -1 || pread(st->fd, text, n, r->offset) != (ssize_t)n) {
+		snprintf(buf, size, "?");
+		return;
+	}
+	for (size_t j = 0; j < n; j++) {
+		if (text[j] == '\t') text[j] = ' ';
+	}
+	text[n] = 0;
+	snprintf(buf, size, "%s%s", text, r->length > n ? "..." : "");
+}
+
+static void strings_overlay_add_quad(struct strings_overlay* so, float x, float y, float w, SDL_Color color)
+{
+	if (so->n_quads >= so->cap_quads) {
+		so->cap_quads = so->cap_quads ? so->cap_quads*2 : 1<<12;
+		so->vertices = realloc(so->vertices, so->cap_quads * 4 * sizeof so->vertices[0]);
+		so->indices = realloc(so->indices, so->cap_quads * 6 * sizeof so->indices[0]);
+		assert(so->vertices != NULL && so->indices != NULL);
+	}
+	const int v = so->n_quads*4;
+	SDL_Vertex* vp = &so->vertices[v];
+	vp[0] = (SDL_Vertex) { {x,   y},   color, {0.0f, 0.0f} };
+	vp[1] = (SDL_Vertex) { {x+w, y},   color, {0.0f, 0.0f} };
+	vp[2] = (SDL_Vertex) { {x+w, y+w}, color, {0.0f, 0.0f} };
+	vp[3] = (SDL_Vertex) { {x,   y+w}, color, {0.0f, 0.0f} };
+	int* ip = &so->indices[so->n_quads*6];
+	ip[0] = v; ip[1] = v+1; ip[2] = v+2;
+	ip[3] = v; ip[4] = v+2; ip[5] = v+3;
+	so->n_quads++;
+}
+
+// block is the index of an aligned run of 4^level points, which covers the
+// square at (bx,by) in units of 1<<level cells
+static void strings_descend(struct strings_descent* sd, uint64_t block, int level, uint32_t bx, uint32_t by)
+{
+	const uint64_t p0 = block << (2*level);
+	if (p0 >= sd->n_points) return;
+	const uint64_t p1_full = (block+1) << (2*level);
+	const uint64_t p1 = p1_full < sd->n_points ? p1_full : sd->n_points;
+	const double size = (double)((uint64_t)1 << level);
+	const double x = bx*size, y = by*size;
+	if (x+size <= sd->x0 || x >= sd->x1 || y+size <= sd->y0 || y >= sd->y1) return;
+	const uint64_t b0 = sd->base + p0*sd->point_size;
+	const uint64_t b1 = sd->base + p1*sd->point_size;
+	const uint64_t c = strings_covered(sd->st, b1) - strings_covered(sd->st, b0);
+	if (c == 0) return;
+	if ((c == b1-b0 && p1 == p1_full) || level == sd->stop_level) {
+		const SDL_Color color = { 0, 255, 255, (Uint8)(1 + 110*c / (b1-b0)) };
+		strings_overlay_add_quad(sd->so, sd->dst.x + x*sd->cs, sd->dst.y + y*sd->cs, size*sd->cs, color);
+		return;
+	}
+	uint64_t ds[4];
+	uint32_t xs[4], ys[4];
+	for (int q = 0; q < 4; q++) ds[q] = block*4 + q;
+	uncurl_d2xy(sd->width_log2 - (level-1), 4, ds, xs, ys);
+	for (int q = 0; q < 4; q++) strings_descend(sd, ds[q], level-1, xs[q], ys[q]);
+}
+
+// the image starts at byte base, with point_size bytes per point
+static void strings_overlay_draw(struct strings_overlay* so, const struct strings* st, SDL_Renderer* renderer, SDL_Rect dst, int width_log2, size_t base, size_t point_size, size_t n_points)
+{
+	const int is_same = so->is_valid
+		&& memcmp(&dst, &so->dst, sizeof dst) == 0
+		&& window_width == so->window_width
+		&& window_height == so->window_height
+		&& base == so->base
+		&& st->version == so->version;
+	if (!is_same) {
+		so->is_valid = 1;
+		so->dst = dst;
+		so->window_width = window_width;
+		so->window_height = window_height;
+		so->base = base;
+		so->version = st->version;
+		so->n_quads = 0;
+
+		struct strings_descent sd = {
+			.st = st,
+			.so = so,
+			.width_log2 = width_log2,
+			.n_points = n_points,
+			.base = base,
+			.point_size = point_size,
+			.cs = (double)dst.w / ((uint64_t)1 << width_log2),
+			.dst = dst,
+		};
+		while (sd.stop_level < width_log2 && ((uint64_t)1 << sd.stop_level)*sd.cs < STRINGS_MIN_STEP) sd.stop_level++;
+		sd.x0 = -dst.x / sd.cs;
+		sd.y0 = -dst.y / sd.cs;
+		sd.x1 = (window_width - dst.x) / sd.cs;
+		sd.y1 = (window_height - dst.y) / sd.cs;
+		strings_descend(&sd, 0, width_log2, 0, 0);
+	}
+	if (so->n_quads > 0) {
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+		SDL_RenderGeometry(renderer, NULL, so->vertices, so->n_quads*4, so->indices, so->n_quads*6);
+	}
+}
+
+// typed value queries (find:<QUERY>) tint the cells holding values of a type
+// in a range: <TYPE>[@<ALIGN>]:<LO>[:<HI>], where TYPE is u8 to u64, i8 to
+// i64, f32 or f64, little-endian unless suffixed "be" (u32be), and ALIGN
+// defaults to the type's size; e.g. find:u32:0x1000:0x1fff, find:i16@1:-5:5
+// or find:f64:nan. the input is scanned in the background into a prefix sum
+// of hits per block of VALUES_BLOCK_POINTS points, and the overlay descends
+// the curve like the strings one. a block is a square of the curve, so only
+// the overlay's smallest squares cut blocks; those ends are counted from the
+// data, so counts are exact. the title shows the hits in view, and F toggles
+// the overlay. the scan runs as many jobs, so a new query cancels what's
+// left of the last one; the jobs already running are left to finish on
+// their own rather than waited for.
+#define VALUES_BLOCK_POINTS (1<<10)
+#define VALUES_ALIGN_MAX (1<<20)
+// blocks per scan job; jobs start at multiples of the largest alignment
+#define VALUES_SCAN_BLOCKS (1<<12)
+
+// one query's scan. jobs put each block's hits in before[i+1], and the UI
+// thread turns that into the prefix sum once they're through
+struct values_scan {
+	struct uncurl_value_query query;
+	const uint8_t* data;
+	size_t size, block_size, n_blocks;
+	uint64_t* before;
+	struct uncurl_batch* batch;
+	struct values_scan* next; // among the retired ones
+};
+
+struct values {
+	char* path;
+	const uint8_t* data; // NULL: map path on the first query
+	size_t size, block_size;
+	struct uncurl_value_query query;
+	char* text; // the query as given; NULL if there's none
+	struct values_scan* scan; // NULL once it's done
+	struct values_scan* retired; // cancelled, with jobs still running
+	uint64_t* before; // hits before each block, and in all; NULL until then
+	size_t n_blocks;
+	size_t version; // bumped by new queries and when a scan is done
+};
+
+struct values_overlay {
+	struct strings_overlay tint; // the same quads as the strings overlay's
+	uint64_t in_view;
+};
+
+struct values_descent {
+	const struct values* v;
+	struct values_overlay* vo;
+	int width_log2;
+	size_t n_points, base, point_size;
+	int stop_level;
+	double cs; // cell size in screen pixels
+	SDL_Rect dst;
+	double x0, y0, x1, y1; // visible region in cells
+};
+
+// returns 0 on errors
+static int values_parse(const char* s, struct uncurl_value_query* q)
+{
+	memset(q, 0, sizeof *q);
+	switch (s[0]) {
+	case 'u': q->type = UNCURL_VALUE_UNSIGNED; break;
+	case 'i': q->type = UNCURL_VALUE_SIGNED; break;
+	case 'f': q->type = UNCURL_VALUE_FLOAT; break;
+	default: return 0;
+	}
+	char* end;
+	const long bits = strtol(s+1, &end, 10);
+	if (bits != 8 && bits != 16 && bits != 32 && bits != 64) return 0;
+	if (q->type == UNCURL_VALUE_FLOAT && bits < 32) return 0;
+	q->width = bits/8;
+	q->alignment = q->width;
+	const char* p = end;
+	if (starts_with(p, "be", &p)) {
+		q->is_be = 1;
+	} else {
+		starts_with(p, "le", &p);
+	}
+	if (*p == '@') {
+		const unsigned long long a = strtoull(p+1, &end, 0);
+		if (a == 0 || a > VALUES_ALIGN_MAX || (a & (a-1)) != 0) return 0;
+		q->alignment = a;
+		p = end;
+	}
+	if (*p++ != ':') return 0;
+	if (q->type == UNCURL_VALUE_FLOAT && strcmp(p, "nan") == 0) {
+		q->is_nan = 1;
+		return 1;
+	}
+	for (int i = 0; i < 2; i++) {
+		if (*p == 0) return 0;
+		if (q->type == UNCURL_VALUE_UNSIGNED) {
+			if (*p == '-') return 0;
+			q->hi.u = strtoull(p, &end, 0);
+			if (i == 0) q->lo.u = q->hi.u;
+		} else if (q->type == UNCURL_VALUE_SIGNED) {
+			q->hi.i = strtoll(p, &end, 0);
+			if (i == 0) q->lo.i = q->hi.i;
+		} else {
+			q->hi.f = strtod(p, &end);
+			if (isnan(q->hi.f)) return 0;
+			if (i == 0) q->lo.f = q->hi.f;
+		}
+		p = end;
+		if (*p == 0) return 1;
+		if (i == 0 && *p++ != ':') return 0;
+	}
+	return *p == 0;
+}
+
+static void values_scan_job(void* usr, int job)
+{
+	struct values_scan* vs = usr;
+	const size_t k0 = (size_t)job * VALUES_SCAN_BLOCKS;
+	const size_t k1 = k0 + VALUES_SCAN_BLOCKS < vs->n_blocks ? k0 + VALUES_SCAN_BLOCKS : vs->n_blocks;
+	// and the values that start in the job's last bytes and end past them;
+	// those in the following block land in the spare count
+	const size_t b0 = k0 * vs->block_size;
+	const size_t b1_full = k1 * vs->block_size + vs->query.width - 1;
+	const size_t b1 = b1_full < vs->size ? b1_full : vs->size;
+	uint32_t counts[VALUES_SCAN_BLOCKS + 1];
+	uncurl_values_count(vs->data + b0, b1 - b0, &vs->query, vs->block_size, counts);
+	for (size_t k = k0; k < k1; k++) vs->before[k+1] = counts[k - k0];
+}
+
+static void values_scan_free(struct values_scan* vs)
+{
+	uncurl_batch_release(vs->batch);
+	free(vs->before);
+	free(vs);
+}
+
+// queries data, or the file at path if data is NULL. point_size is that of
+// the view
+static struct values* values_open(const char* path, const uint8_t* data, size_t size, size_t point_size)
+{
+	struct values* v = calloc(1, sizeof *v);
+	assert(v != NULL);
+	v->path = strdup(path);
+	assert(v->path != NULL);
+	v->data = data;
+	v->size = size;
+	v->block_size = point_size * VALUES_BLOCK_POINTS;
+	return v;
+}
+
+// starts a query, or clears it if text is NULL. the last one's scan is
+// cancelled and retired; values_update() frees it once it's through
+static void values_find(struct values* v, const struct uncurl_value_query* q, const char* text)
+{
+	if (v->scan != NULL) {
+		uncurl_batch_cancel(v->scan->batch);
+		v->scan->next = v->retired;
+		v->retired = v->scan;
+		v->scan = NULL;
+	}
+	free(v->before);
+	v->before = NULL;
+	free(v->text);
+	v->text = NULL;
+	v->version++;
+	if (text == NULL) return;
+	v->text = strdup(text);
+	assert(v->text != NULL);
+	v->query = *q;
+	if (v->data == NULL) {
+		v->data = map_file(v->path, &v->size);
+		if (v->data == NULL) return;
+	}
+	// block_size*VALUES_SCAN_BLOCKS is a multiple of VALUES_ALIGN_MAX, so
+	// each job's data starts aligned
+	struct values_scan* vs = calloc(1, sizeof *vs);
+	assert(vs != NULL);
+	vs->query = *q;
+	vs->data = v->data;
+	vs->size = v->size;
+	vs->block_size = v->block_size;
+	vs->n_blocks = (v->size + v->block_size - 1) / v->block_size;
+	vs->before = malloc((vs->n_blocks + 1) * sizeof vs->before[0]);
+	assert(vs->before != NULL);
+	vs->before[0] = 0;
+	const int n_jobs = (vs->n_blocks + VALUES_SCAN_BLOCKS - 1) / VALUES_SCAN_BLOCKS;
+	vs->batch = uncurl_submit(n_jobs, values_scan_job, vs, UNCURL_PRIORITY_BACKGROUND);
+	v->scan = vs;
+}
+
+// frees retired scans that are through. returns 1 once the query's scan is
+// done
+static int values_update(struct values* v)
+{
+	for (struct values_scan** p = &v->retired; *p != NULL;) {
+		struct values_scan* vs = *p;
+		if (uncurl_batch_is_done(vs->batch)) {
+			*p = vs->next;
+			values_scan_free(vs);
+		} else {
+			p = &vs->next;
+		}
+	}
+	struct values_scan* vs = v->scan;
+	if (vs != NULL && uncurl_batch_is_done(vs->batch)) {
+		for (size_t i = 0; i < vs->n_blocks; i++) vs->before[i+1] += vs->before[i];
+		v->before = vs->before;
+		v->n_blocks = vs->n_blocks;
+		vs->before = NULL;
+		values_scan_free(vs);
+		v->scan = NULL;
+		v->version++;
+	}
+	return v->scan == NULL && v->before != NULL;
+}
+
+// hits starting in [b0;b1), counted from the data
+static uint64_t values_scan_range(const struct values* v, uint64_t b0, uint64_t b1)
+{
+	const uint64_t a = v->query.alignment;
+	b0 = (b0 + a-1) & ~(a-1);
+	const uint64_t end = b1 - 1 + v->query.width < v->size ? b1 - 1 + v->query.width : v->size;
+	if (b0 >= b1 || b0 >= end) return 0;
+	// queries are checked by values_parse(); -1 could only be out of memory
+	const int64_t n = uncurl_values_count(v->data + b0, end - b0, &v->query, v->block_size, NULL);
+	return n > 0 ? n : 0;
+}
+
+// hits starting in [b0;b1); whole blocks from the prefix sum
+static uint64_t values_in(const struct values* v, uint64_t b0, uint64_t b1)
+{
+	if (b1 > v->size) b1 = v->size;
+	if (b0 >= b1) return 0;
+	const uint64_t k0 = (b0 + v->block_size-1) / v->block_size;
+	const uint64_t k1 = b1 / v->block_size;
+	if (k0 >= k1) return values_scan_range(v, b0, b1);
+	return v->before[k1] - v->before[k0]
+		+ values_scan_range(v, b0, k0*v->block_size)
+		+ values_scan_range(v, k1*v->block_size, b1);
+}
+
+// as strings_descend(); blocks wholly in view are counted at once
+static void values_descend(struct values_descent* vd, uint64_t block, int level, uint32_t bx, uint32_t by, int is_counted)
+{
+	const uint64_t p0 = block << (2*level);
+	if (p0 >= vd->n_points) return;
+	const uint64_t p1_full = (block+1) << (2*level);
+	const uint64_t p1 = p1_full < vd->n_points ? p1_full : vd->n_points;
+	const double size = (double)((uint64_t)1 << level);
+	const double x = bx*size, y = by*size;
+	if (x+size <= vd->x0 || x >= vd->x1 || y+size <= vd->y0 || y >= vd->y1) return;
+	const uint64_t b0 = vd->base + p0*vd->point_size;
+	const uint64_t b1_full = vd->base + p1*vd->point_size;
+	const uint64_t b1 = b1_full < vd->v->size ? b1_full : vd->v->size;
+	const uint64_t c = values_in(vd->v, b0, b1);
+	if (c == 0) return;
+	if (!is_counted && x >= vd->x0 && x+size <= vd->x1 && y >= vd->y0 && y+size <= vd->y1) {
+		vd->vo->in_view += c;
+		is_counted = 1;
+	}
+	// as dense as the alignment allows
+	const uint64_t n_max = (b1 - b0 + vd->v->query.alignment - 1) / vd->v->query.alignment;
+	if ((c >= n_max && p1 == p1_full) || level == vd->stop_level) {
+		if (!is_counted) vd->vo->in_view += c;
+		const uint64_t density = c < n_max ? c : n_max;
+		const SDL_Color color = { 255, 0, 255, (Uint8)(40 + 120*density / n_max) };
+		strings_overlay_add_quad(&vd->vo->tint, vd->dst.x + x*vd->cs, vd->dst.y + y*vd->cs, size*vd->cs, color);
+		return;
+	}
+	uint64_t ds[4];
+	uint32_t xs[4], ys[4];
+	for (int q = 0; q < 4; q++) ds[q] = block*4 + q;
+	uncurl_d2xy(vd->width_log2 - (level-1), 4, ds, xs, ys);
+	for (int q = 0; q < 4; q++) values_descend(vd, ds[q], level-1, xs[q], ys[q], is_counted);
+}
+
+// the image starts at byte base, with point_size bytes per point
+static void values_overlay_draw(struct values_overlay* vo, const struct values* v, SDL_Renderer* renderer, SDL_Rect dst, int width_log2, size_t base, size_t point_size, size_t n_points)
+{
+	struct strings_overlay* so = &vo->tint;
+	const int is_same = so->is_valid
+		&& memcmp(&dst, &so->dst, sizeof dst) == 0
+		&& window_width == so->window_width
+		&& window_height == so->window_height
+		&& base == so->base
+		&& v->version == so->version;
+	if (!is_same) {
+		so->is_valid = 1;
+		so->dst = dst;
+		so->window_width = window_width;
+		so->window_height = window_height;
+		so->base = base;
+		so->version = v->version;
+		so->n_quads = 0;
+		vo->in_view = 0;
+
+		struct values_descent vd = {
+			.v = v,
+			.vo = vo,
+			.width_log2 = width_log2,
+			.n_points = n_points,
+			.base = base,
+			.point_size = point_size,
+			.cs = (double)dst.w / ((uint64_t)1 << width_log2),
+			.dst = dst,
+		};
+		while (vd.stop_level < width_log2 && ((uint64_t)1 << vd.stop_level)*vd.cs < STRINGS_MIN_STEP) vd.stop_level++;
+		vd.x0 = -dst.x / vd.cs;
+		vd.y0 = -dst.y / vd.cs;
+		vd.x1 = (window_width - dst.x) / vd.cs;
+		vd.y1 = (window_height - dst.y) / vd.cs;
+		values_descend(&vd, 0, width_log2, 0, 0, 0);
+	}
+	if (so->n_quads > 0) {
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+		SDL_RenderGeometry(renderer, NULL, so->vertices, so->n_quads*4, so->indices, so->n_quads*6);
+	}
+}
+
+// byte views (palette:<NAME>) draw every input byte as one point, colored
+// through a palette. the image is kept as palette indices, one byte per
+// pixel, and there's no full-size texture: each pane expands just the part
+// in view to RGB, at no more than screen resolution, into a texture about
+// the size of the pane. changing the palette (or the view) re-expands that
+// part; nothing is rasterized again. palettes map 0 to black, like the
+// background past the data.
+
+#define EMIT_PALETTES \
+	X(class) \
+	X(gray) \
+	X(heat)
+
+enum palette {
+	#define X(NAME) PALETTE_ ## NAME,
+	EMIT_PALETTES
+	#undef X
+	N_PALETTES
+};
+
+static const char* palette_names[] = {
+	#define X(NAME) #NAME,
+	EMIT_PALETTES
+	#undef X
+};
+
+static uint8_t palettes[N_PALETTES][256][N_COMP];
+
+static void palettes_init(void)
+{
+	for (int i = 0; i < 256; i++) {
+		// zero, control, printable ASCII, high bytes and 0xff apart, with
+		// some shading within each so runs still show structure
+		uint8_t* c = palettes[PALETTE_class][i];
+		if (i == 0) {
+			c[0] = c[1] = c[2] = 0;
+		} else if (i == 0xff) {
+			c[0] = c[1] = c[2] = 255;
+		} else if (0x20 <= i && i < 0x7f) {
+			c[0] = 30; c[1] = 90 + (i-0x20); c[2] = 255;
+		} else if (i < 0x80) {
+			c[0] = 40; c[1] = 160 + (i & 0x1f)*2; c[2] = 60;
+		} else {
+			c[0] = 128 + (i-0x80); c[1] = 30; c[2] = 40;
+		}
+		c = palettes[PALETTE_gray][i];
+		c[0] = c[1] = c[2] = i;
+		// black, red, yellow, white
+		c = palettes[PALETTE_heat][i];
+		c[0] = i < 85 ? i*3 : 255;
+		c[1] = i < 85 ? 0 : i < 170 ? (i-85)*3 : 255;
+		c[2] = i < 170 ? 0 : (i-170)*3;
+	}
+}
+
+// what a pane last showed, and where
+struct indexed_pane {
+	SDL_Texture* texture;
+	int texture_w, texture_h;
+	int is_valid;
+	SDL_Rect dst;
+	int window_width, window_height;
+	int palette;
+	SDL_Rect src; // the part of the texture in use; empty if nothing's in view
+	SDL_FRect to;
+};
+
+struct indexed_view {
+	int width_log2;
+	uint8_t* image; // palette indices
+	struct indexed_pane panes[MAX_PANES];
+	uint8_t* rgb; // expanded texels
+	int* cols; // image x for each texel column
+	size_t rgb_cap, cols_cap;
+};
+
+static struct indexed_view* indexed_view_new(const uint8_t* data, size_t n_points, int width_log2)
+{
+	struct indexed_view* iv = calloc(1, sizeof *iv);
+	assert(iv != NULL);
+	const size_t width = (size_t)1 << width_log2;
+	iv->width_log2 = width_log2;
+	iv->image = malloc(width*width);
+	assert(iv->image != NULL);
+	uncurl_rasterize_index(data, n_points, width_log2, iv->image, width);
+	return iv;
+}
+
+// expands the part of the image drawn at dst that's in the window (with the
+// current window_width/window_height) and draws it. one texel per image
+// pixel when zoomed in, about one per screen pixel when zoomed out
+static void indexed_view_draw(struct indexed_view* iv, SDL_Renderer* renderer, int pane, SDL_Rect dst, int palette)
+{
+	struct indexed_pane* ip = &iv->panes[pane];
+	const int is_same = ip->is_valid
+		&& memcmp(&dst, &ip->dst, sizeof dst) == 0
+		&& window_width == ip->window_width
+		&& window_height == ip->window_height
+		&& palette == ip->palette;
+	if (!is_same) {
+		ip->is_valid = 1;
+		ip->dst = dst;
+		ip->window_width = window_width;
+		ip->window_height = window_height;
+		ip->palette = palette;
+		ip->src = (SDL_Rect){0};
+
+		const int width = 1 << iv->width_log2;
+		const double cs = (double)dst.w / width; // image pixel size on screen
+		if (cs <= 0.0) return;
+		int ix0 = floor(-dst.x / cs), ix1 = ceil((window_width - dst.x) / cs);
+		int iy0 = floor(-dst.y / cs), iy1 = ceil((window_height - dst.y) / cs);
+		if (ix0 < 0) ix0 = 0;
+		if (iy0 < 0) iy0 = 0;
+		if (ix1 > width) ix1 = width;
+		if (iy1 > width) iy1 = width;
+		if (ix1 <= ix0 || iy1 <= iy0) return;
+		int tw = ix1 - ix0, th = iy1 - iy0;
+		if (cs < 1.0) {
+			tw = ceil(tw * cs);
+			th = ceil(th * cs);
+		}
+
+		if (ip->texture == NULL || ip->texture_w < tw || ip->texture_h < th) {
+			if (ip->texture != NULL) SDL_DestroyTexture(ip->texture);
+			// room for the pane plus partly visible pixels, so resizes and
+			// zooming seldom need a new one
+			ip->texture_w = tw > window_width+2 ? tw : window_width+2;
+			ip->texture_h = th > window_height+2 ? th : window_height+2;
+			ip->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, ip->texture_w, ip->texture_h);
+			if (ip->texture == NULL) SDL2FATAL();
+			SDL_SetTextureScaleMode(ip->texture, SDL_ScaleModeNearest);
+		}
+		if ((size_t)tw*th*N_COMP > iv->rgb_cap) {
+			iv->rgb_cap = (size_t)tw*th*N_COMP;
+			iv->rgb = realloc(iv->rgb, iv->rgb_cap);
+			assert(iv->rgb != NULL);
+		}
+		if ((size_t)tw > iv->cols_cap) {
+			iv->cols_cap = tw;
+			iv->cols = realloc(iv->cols, iv->cols_cap * sizeof iv->cols[0]);
+			assert(iv->cols != NULL);
+		}
+
+		// nearest image pixel to each texel's center
+		for (int x = 0; x < tw; x++) iv->cols[x] = ix0 + (int)(((int64_t)(2*x+1) * (ix1-ix0)) / (2*tw));
+		const uint8_t (*pal)[N_COMP] = palettes[palette];
+		for (int y = 0; y < th; y++) {
+			const int iy = iy0 + (int)(((int64_t)(2*y+1) * (iy1-iy0)) / (2*th));
+			const uint8_t* rp = &iv->image[(size_t)iy << iv->width_log2];
+			uint8_t* wp = &iv->rgb[(size_t)y*tw*N_COMP];
+			for (int x = 0; x < tw; x++) {
+				memcpy(wp, pal[rp[iv->cols[x]]], N_COMP);
+				wp += N_COMP;
+			}
+		}
+		ip->src = (SDL_Rect){ 0, 0, tw, th };
+		SDL_UpdateTexture(ip->texture, &ip->src, iv->rgb, tw*N_COMP);
+		ip->to = (SDL_FRect){ dst.x + ix0*cs, dst.y + iy0*cs, (ix1-ix0)*cs, (iy1-iy0)*cs };
+	}
+	if (ip->src.w > 0) SDL_RenderCopyF(renderer, ip->texture, &ip->src, &ip->to);
+}
+
+// compressibility heatmaps (compress, or compress:<BLOCK> for blocks other
+// than 4k): each block of the input is a point, colored by how well it
+// compresses (see uncurl_compressibility()) through the byte view palettes;
+// heat unless palette:<NAME> says otherwise. results are cached in
+// $XDG_CACHE_HOME/uncurl (or ~/.cache/uncurl) under the input's device,
+// inode and block size, and checked against its size and mtime, so opening
+// the same input again is instant. only regular files are cached; a block
+// device's node keeps its size and mtime when the disk is rewritten.
+#define COMPRESS_DEFAULT_BLOCK (4096)
+
+struct compress_cache_header {
+	char magic[8];
+	uint64_t size, mtime_sec, mtime_nsec, block_size;
+};
+
+// returns 0 if there's nowhere to cache
+static int compress_cache_path(const struct stat* st, size_t block_size, char* buf, size_t size)
+{
+	const char* xdg = getenv("XDG_CACHE_HOME");
+	const char* home = getenv("HOME");
+	char dir[1<<12];
+	if (xdg != NULL && xdg[0] != 0) {
+		mkdir(xdg, 0755);
+		snprintf(dir, sizeof dir, "%s/uncurl", xdg);
+	} else if (home != NULL && home[0] != 0) {
+		snprintf(dir, sizeof dir, "%s/.cache", home);
+		mkdir(dir, 0755);
+		snprintf(dir, sizeof dir, "%s/.cache/uncurl", home);
+	} else {
+		return 0;
+	}
+	mkdir(dir, 0755);
+	const int n = snprintf(buf, size, "%s/compress-%llx-%llx-%zu", dir, (unsigned long long)st->st_dev, (unsigned long long)st->st_ino, block_size);
+	return n > 0 && (size_t)n < size;
+}
+
+// returns a malloc()'d point per block, or NULL on errors
+static uint8_t* compress_load(const char* path, size_t block_size, size_t* out_n_blocks)
+{
+	const int fd = open(path, O_RDONLY);
+	struct stat st;
+	if (fd == -1 || fstat(fd, &st) == -1) {
+		fprintf(stderr, "%s: could not open\n", path);
+		if (fd != -1) close(fd);
+		return NULL;
+	}
+	// st_size is 0 for block devices; seeking to the end works for both
+	const off_t size = lseek(fd, 0, SEEK_END);
+	close(fd);
+	if (size <= 0) {
+		fprintf(stderr, "%s: could not determine size (or empty)\n", path);
+		return NULL;
+	}
+	struct compress_cache_header header = {
+		.magic = "uncurlC1",
+		.size = size,
+		.mtime_sec = st.st_mtim.tv_sec,
+		.mtime_nsec = st.st_mtim.tv_nsec,
+		.block_size = block_size,
+	};
+	const size_t n_blocks = (size + block_size - 1) / block_size;
+	uint8_t* blocks = malloc(n_blocks);
+	assert(blocks != NULL);
+	*out_n_blocks = n_blocks;
+
+	char cache_path[1<<12];
+	const int has_cache = S_ISREG(st.st_mode) && compress_cache_path(&st, block_size, cache_path, sizeof cache_path);
+	if (has_cache) {
+		FILE* f = fopen(cache_path, "rb");
+		if (f != NULL) {
+			struct compress_cache_header cached;
+			const int is_hit = fread(&cached, sizeof cached, 1, f) == 1
+				&& memcmp(&cached, &header, sizeof header) == 0
+				&& fread(blocks, 1, n_blocks, f) == n_blocks;
+			fclose(f);
+			if (is_hit) return blocks;
+		}
+	}
+
+	size_t map_size;
+	const uint8_t* map = map_file(path, &map_size);
+	if (map == NULL) {
+		free(blocks);
+		return NULL;
+	}
+	madvise((void*)map, map_size, MADV_SEQUENTIAL);
+	const int is_done = uncurl_compressibility(map, size, block_size, blocks) == 0;
+	munmap((void*)map, map_size);
+	if (!is_done) {
+		fprintf(stderr, "%s: bad block size %zu\n", path, block_size);
+		free(blocks);
+		return NULL;
+	}
+
+	// written aside and renamed, so a cache file is either whole or missing
+	if (has_cache) {
+		char tmp_path[(1<<12) + 32];
+		snprintf(tmp_path, sizeof tmp_path, "%s.%d", cache_path, (int)getpid());
+		FILE* f = fopen(tmp_path, "wb");
+		if (f != NULL) {
+			const int is_written = fwrite(&header, sizeof header, 1, f) == 1 && fwrite(blocks, 1, n_blocks, f) == n_blocks;
+			if (fclose(f) == 0 && is_written) {
+				rename(tmp_path, cache_path);
+			} else {
+				unlink(tmp_path);
+			}
+		}
+	}
+	return blocks;
+}
+
+// a static (or overview) view of one input. normally there's just the one,
+// but with control:<PATH> "open" can load more; each keeps its data,
+// textures and LOD levels, so switching back is instant
+#define DOC_MAX (64)
+
+struct doc {
+	char* path;
+	struct uncurl_input_set inputs;
+	int is_multi_file;
+	uint8_t* data; // NULL for the overview
+	struct overview* overview;
+	size_t input_length;
+	int width_log2;
+	SDL_Texture* texture;
+	struct lod* lod;
+	SDL_Texture* boundary_texture;
+	int fd; // extract source; -1 unless a single file
+	int n_offset_digits;
+	struct elf_map* elf; // NULL unless a single ELF file
+	size_t point_size; // input bytes per point; N_COMP unless projected or bytes
+	int is_indexed; // byte views and compressibility heatmaps
+	struct indexed_view* indexed;
+	struct pointers* pointers; // NULL unless asked for
+	struct strings* strings; // likewise
+	struct values* values; // for find:<QUERY> and "find"
+};
+
+// channel composites (green:<PATH> and blue:<PATH>, with the input as red)
+// draw three inputs of one byte per point as the channels of one view, e.g.
+// the bands of a satellite image or three dumps of the same memory. the
+// inputs are mapped and read ahead all at once, so the reads overlap, and
+// interleaved straight into the one image kept in memory. shorter inputs are
+// black in their channel past their end.
+static uint8_t* composite_load(const char* const* paths, size_t* out_n_points)
+{
+	const uint8_t* maps[N_COMP];
+	size_t sizes[N_COMP];
+	size_t n_points = 0;
+	for (int c = 0; c < N_COMP; c++) {
+		maps[c] = map_file(paths[c], &sizes[c]);
+		if (maps[c] == NULL) {
+			while (--c >= 0) munmap((void*)maps[c], sizes[c]);
+			return NULL;
+		}
+		madvise((void*)maps[c], sizes[c], MADV_WILLNEED);
+		if (sizes[c] > n_points) n_points = sizes[c];
+	}
+	uint8_t* data = malloc(n_points*N_COMP);
+	assert(data != NULL);
+	uncurl_interleave(maps, sizes, n_points, data);
+	for (int c = 0; c < N_COMP; c++) munmap((void*)maps[c], sizes[c]);
+	*out_n_points = n_points;
+	return data;
+}
+
+// how inputs are to be loaded; the same for all of them
+struct doc_options {
+	int use_overview;
+	size_t record_size; // 0 unless record:<SIZE>
+	enum uncurl_projection_type projection;
+	int is_bytes; // palette:<NAME>
+	int use_pointers, has_pointer_base;
+	uint64_t pointer_base;
+	size_t strings_min; // 0 unless strings
+	size_t compress_block; // 0 unless compress
+	const char* green_path; // green:<PATH> and blue:<PATH>; NULL unless a composite
+	const char* blue_path;
+	const char* find_text; // NULL unless find:<QUERY>
+	struct uncurl_value_query find_query;
+};
+
+// reads the input (or samples it, for the overview). the doc takes over
+// inputs. returns 0 on errors, leaving what it got to doc_free()
+static int doc_load(struct doc* doc, const char* path, const struct uncurl_input_set* inputs, int is_multi_file, const struct doc_options* opt)
+{
+	memset(doc, 0, sizeof *doc);
+	doc->fd = -1;
+	doc->inputs = *inputs;
+	doc->point_size = opt->is_bytes ? 1 : N_COMP;
+	const int is_file = !is_multi_file && strcmp(path, "-") != 0;
+	const size_t record_size = opt->record_size;
+	int use_overview = opt->use_overview;
+	if (record_size > 0 && !is_file) {
+		fprintf(stderr, "record:<SIZE> needs a single input file\n");
+		return 0;
+	}
+	if (opt->is_bytes && is_multi_file) {
+		fprintf(stderr, "palette:<NAME> needs a single input\n");
+		return 0;
+	}
+	if (opt->use_pointers && !is_file) {
+		fprintf(stderr, "pointers needs a single input file\n");
+		return 0;
+	}
+	if (opt->compress_block > 0 && !is_file) {
+		fprintf(stderr, "compress needs a single input file\n");
+		return 0;
+	}
+	const int is_composite = opt->green_path != NULL;
+	if (is_composite && !is_file) {
+		fprintf(stderr, "green:<PATH> and blue:<PATH> need a single input file\n");
+		return 0;
+	}
+	if (!use_overview && is_file && record_size == 0 && !opt->is_bytes && opt->compress_block == 0 && !is_composite) {
+		const int fd = open(path, O_RDONLY);
+		if (fd != -1) {
+			const off_t size = lseek(fd, 0, SEEK_END);
+			if (size > ((off_t)N_COMP << (2*OVERVIEW_AUTO_LOG2))) use_overview = 1;
+			close(fd);
+		}
+	}
+	if (record_size > 0) {
+		// the records are only ever looked at here; the mapping goes once
+		// they're projected, so only the projected image stays in memory
+		size_t size;
+		const uint8_t* records = map_file(path, &size);
+		if (records == NULL) return 0;
+		const size_t n_records = size / record_size;
+		if (n_records == 0) {
+			fprintf(stderr, "%s: no complete records of %zu bytes\n", path, record_size);
+			munmap((void*)records, size);
+			return 0;
+		}
+		madvise((void*)records, size, MADV_SEQUENTIAL);
+		struct uncurl_projection* proj = malloc(sizeof *proj);
+		assert(proj != NULL);
+		uncurl_projection_fit(proj, opt->projection, records, n_records, record_size);
+		doc->data = malloc(n_records * N_COMP);
+		assert(doc->data != NULL);
+		uncurl_project(proj, records, n_records, doc->data);
+		free(proj);
+		munmap((void*)records, size);
+		doc->input_length = n_records;
+		doc->point_size = record_size;
+	} else if (opt->compress_block > 0) {
+		doc->data = compress_load(path, opt->compress_block, &doc->input_length);
+		if (doc->data == NULL) return 0;
+		doc->point_size = opt->compress_block;
+		doc->is_indexed = 1;
+	} else if (is_composite) {
+		const char* paths[N_COMP] = { path, opt->green_path, opt->blue_path };
+		doc->data = composite_load(paths, &doc->input_length);
+		if (doc->data == NULL) return 0;
+		doc->point_size = 1;
+	} else if (use_overview) {
+		if (!is_file) {
+			fprintf(stderr, "overview needs a single input file\n");
+			return 0;
+		}
+		doc->overview = overview_open(path);
+		if (doc->overview == NULL) return 0;
+		doc->input_length = doc->overview->n_points;
+	} else {
+		size_t raw_input_data_size;
+		if (is_multi_file) {
+			doc->data = uncurl_input_set_read((struct uncurl_input_set*)inputs);
+			if (doc->data == NULL) {
+				fprintf(stderr, "%s\n", inputs->error);
+				return 0;
+			}
+			raw_input_data_size = inputs->total_size;
+		} else {
+			doc->data = uncurl_read_entire_file(path, &raw_input_data_size);
+			if (doc->data == NULL) {
+				fprintf(stderr, "%s: could not open\n", path);
+				return 0;
+			}
+		}
+		if ((raw_input_data_size % doc->point_size) != 0) {
+			fprintf(stderr, "%s: number of bytes must be a multiple of %d\n", path, N_COMP);
+			return 0;
+		}
+		doc->input_length = raw_input_data_size / doc->point_size;
+		doc->is_indexed = opt->is_bytes;
+	}
+	doc->path = strdup(path);
+	doc->is_multi_file = is_multi_file;
+	doc->width_log2 = uncurl_width_log2_for_length(doc->input_length);
+	if (is_file && !is_composite) {
+		doc->fd = open(path, O_RDONLY);
+		if (record_size == 0) doc->elf = elf_open(path);
+		if (opt->use_pointers) {
+			doc->pointers = pointers_open(path, doc->elf, opt->has_pointer_base, opt->pointer_base);
+			if (doc->pointers == NULL) return 0;
+		}
+	}
+	// the overview and records don't keep the input bytes, and nor do
+	// composites; strings and values are in the red input then
+	const int has_bytes = doc->data != NULL && record_size == 0 && opt->compress_block == 0 && !is_composite;
+	if (opt->strings_min > 0) {
+		doc->strings = strings_open(path, has_bytes ? doc->data : NULL, doc->input_length*doc->point_size, opt->strings_min);
+	}
+	if (has_bytes || is_file) {
+		doc->values = values_open(path, has_bytes ? doc->data : NULL, doc->input_length*doc->point_size, doc->point_size);
+		if (opt->find_text != NULL) values_find(doc->values, &opt->find_query, opt->find_text);
+	}
+	doc->n_offset_digits = 1;
+	const size_t total = doc->input_length*doc->point_size;
+	while (doc->n_offset_digits < 16 && (total-1) >> (4*doc->n_offset_digits)) doc->n_offset_digits++;
+	return 1;
+}
+
+// draws the curve and creates the textures
+static void doc_init_view(struct doc* doc, SDL_Renderer* renderer)
+{
+	const int width_log2 = doc->width_log2;
+	const int width = 1<<width_log2;
+	assert((N_COMP == 3) && "hardcoded pixel format needs N_COMP==3");
+	if (doc->overview != NULL) {
+		const int ow = 1 << doc->overview->ov_width_log2;
+		doc->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, ow, ow);
+		if (doc->texture == NULL) SDL2FATAL();
+		SDL_UpdateTexture(doc->texture, NULL, doc->overview->image, N_COMP*ow);
+		overview_start_loading(doc->overview);
+		return;
+	}
+	if (doc->is_indexed) {
+		// palette indices, expanded per pane as they're drawn (so no
+		// texture here). averaging indices makes no sense, so there's no LOD
+		doc->indexed = indexed_view_new(doc->data, doc->input_length, width_log2);
+		return;
+	}
+
+	const Uint32 desired_format = SDL_PIXELFORMAT_RGB24;
+	const int desired_access = SDL_TEXTUREACCESS_STATIC;
+	doc->texture = SDL_CreateTexture(renderer, desired_format, desired_access, width, width);
+	if (doc->texture == NULL) SDL2FATAL();
+	// sanity check (don't know if this is necessary)
+	Uint32 actual_format;
+	int actual_access, actual_width, actual_height;
+	if (SDL_QueryTexture(doc->texture, &actual_format, &actual_access, &actual_width, &actual_height) < 0) SDL2FATAL();
+	assert(actual_format == desired_format);
+	assert(actual_access == desired_access);
+	assert(actual_width == width);
+	assert(actual_height == width); // width==height
+	// a band at a time; a whole image next to the data would double the
+	// memory needed at the peak of large loads
+	const int band_rows = width < UNCURL_BAND_ROWS ? width : UNCURL_BAND_ROWS;
+	uint8_t* band = malloc((size_t)band_rows * width * N_COMP);
+	assert(band != NULL);
+	for (int y0 = 0; y0 < width; y0 += band_rows) {
+		uncurl_rasterize_rows(doc->data, doc->input_length, width_log2, y0, band_rows, band, (size_t)N_COMP*width);
+		const SDL_Rect rect = { 0, y0, width, band_rows };
+		SDL_UpdateTexture(doc->texture, &rect, band, N_COMP*width);
+	}
+	free(band);
+	doc->lod = lod_new(doc->data, doc->input_length, width_log2);
+	if (doc->is_multi_file) {
+		doc->boundary_texture = input_set_boundary_texture_new(&doc->inputs, renderer, width_log2, doc->input_length);
+	}
+}
+
+static void input_set_free(struct uncurl_input_set* set)
+{
+	for (int i = 0; i < set->n_files; i++) {
+		free(set->files[i].path);
+		if (set->files[i].fd != -1) close(set->files[i].fd);
+	}
+	free(set->files);
+}
+
+static void overview_free(struct overview* ov)
+{
+	close(ov->fd);
+	free(ov->image);
+	free(ov->tile_state);
+	free(ov->dirty);
+	pthread_mutex_destroy(&ov->mutex);
+	free(ov);
+}
+
+static void elf_free(struct elf_map* em)
+{
+	free(em->segments);
+	free(em->sections);
+	free(em->names);
+	free(em->squares);
+	free(em);
+}
+
+// frees a doc that doc_load() failed on. the view (and the overview's
+// tile loading) and the strings and values come after the last way to
+// fail, so it only has to undo the loading itself
+static void doc_free(struct doc* doc)
+{
+	assert(doc->texture == NULL && doc->indexed == NULL && doc->pointers == NULL && doc->strings == NULL && doc->values == NULL);
+	free(doc->path);
+	free(doc->data);
+	if (doc->overview != NULL) overview_free(doc->overview);
+	if (doc->fd != -1) close(doc->fd);
+	if (doc->elf != NULL) elf_free(doc->elf);
+	input_set_free(&doc->inputs);
+	free(doc);
+}
+
+// the control "open" command loads in the background, one input at a time,
+// so the viewer keeps drawing and answering meanwhile. the view (textures)
+// is made on the UI thread once the load is through
+struct doc_loader {
+	pthread_t thread;
+	char* path;
+	struct uncurl_input_set inputs;
+	int is_multi_file;
+	const struct doc_options* opt;
+	struct doc* doc;
+	int is_wanted; // switch to it when loaded; cleared by a later "open"
+	pthread_mutex_t mutex;
+	int is_done, is_ok;
+};
+
+static void* doc_loader_thread(void* usr)
+{
+	struct doc_loader* dl = usr;
+	const int is_ok = doc_load(dl->doc, dl->path, &dl->inputs, dl->is_multi_file, dl->opt);
+	pthread_mutex_lock(&dl->mutex);
+	dl->is_ok = is_ok;
+	dl->is_done = 1;
+	pthread_mutex_unlock(&dl->mutex);
+	return NULL;
+}
+
+// returns NULL (having said why on stderr) if the input can't be expanded
+// or the thread can't be started
+static struct doc_loader* doc_loader_start(const char* path, const struct doc_options* opt)
+{
+	struct doc_loader* dl = calloc(1, sizeof *dl);
+	assert(dl != NULL);
+	dl->is_multi_file = uncurl_input_set_expand(&dl->inputs, path);
+	if (dl->is_multi_file < 0) {
+		fprintf(stderr, "%s\n", dl->inputs.error);
+		input_set_free(&dl->inputs);
+		free(dl);
+		return NULL;
+	}
+	dl->path = strdup(path);
+	dl->doc = calloc(1, sizeof *dl->doc);
+	assert(dl->path != NULL && dl->doc != NULL);
+	dl->opt = opt;
+	dl->is_wanted = 1;
+	pthread_mutex_init(&dl->mutex, NULL);
+	if (pthread_create(&dl->thread, NULL, doc_loader_thread, dl) != 0) {
+		fprintf(stderr, "%s: could not start loading\n", path);
+		input_set_free(&dl->inputs);
+		pthread_mutex_destroy(&dl->mutex);
+		free(dl->doc);
+		free(dl->path);
+		free(dl);
+		return NULL;
+	}
+	return dl;
+}
+
+// returns 1 once the load is through; then *out_doc is the loaded doc, or
+// NULL if it failed, and dl is freed
+static int doc_loader_poll(struct doc_loader* dl, struct doc** out_doc)
+{
+	pthread_mutex_lock(&dl->mutex);
+	const int is_done = dl->is_done;
+	pthread_mutex_unlock(&dl->mutex);
+	if (!is_done) return 0;
+	pthread_join(dl->thread, NULL);
+	pthread_mutex_destroy(&dl->mutex);
+	if (dl->is_ok) {
+		*out_doc = dl->doc;
+	} else {
+		doc_free(dl->doc);
+		*out_doc = NULL;
+	}
+	free(dl->path);
+	free(dl);
+	return 1;
+}
+
+// zero-copy extraction of selected byte ranges. the ranges are resolved into
+// pieces of files (or of memory, for stdin and other non-file inputs) on the
+// UI thread, then copied with copy_file_range()/sendfile() so the bytes
+// don't pass through user space. each output has one writer thread working
+// through its jobs in order: a new selection starts the file over (and stops
+// the copying of the old one), and CTRL-added ranges are appended.
+
+#define EXTRACT_CHUNK ((size_t)1<<26) // bytes copied between checks for restarts
+
+struct extract_piece {
+	int fd; // -1 means copy from mem
+	const uint8_t* mem;
+	off_t offset;
+	size_t length;
+};
+
+struct extract_job {
+	int is_restart;
+	int generation; // of the output when queued
+	int n_pieces;
+	struct extract_piece* pieces;
+	struct extract_job* next;
+};
+
+struct extract_output {
+	char* path;
+	int has_thread;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	struct extract_job* head; // queued jobs
+	struct extract_job* tail;
+	int generation; // bumped by restarts; older jobs are dropped
+	int is_closing;
+};
+
+static struct extract_output* extract_output_new(const char* path)
+{
+	struct extract_output* out = calloc(1, sizeof *out);
+	assert(out != NULL);
+	out->path = strdup(path);
+	assert(out->path != NULL);
+	pthread_mutex_init(&out->mutex, NULL);
+	pthread_cond_init(&out->cond, NULL);
+	return out;
+}
+
+static struct extract_job* extract_job_new(int is_restart)
+{
+	struct extract_job* job = calloc(1, sizeof *job);
+	assert(job != NULL);
+	job->is_restart = is_restart;
+	return job;
+}
+
+static void extract_job_free(struct extract_job* job)
+{
+	free(job->pieces);
+	free(job);
+}
+
+static void extract_job_add_piece(struct extract_job* job, int fd, const uint8_t* mem, off_t offset, size_t length)
+{
+	if (length == 0) return;
+	job->pieces = realloc(job->pieces, (job->n_pieces+1) * sizeof job->pieces[0]);
+	assert(job->pieces != NULL);
+	struct extract_piece* p = &job->pieces[job->n_pieces++];
+	p->fd = fd;
+	p->mem = mem;
+	p->offset = offset;
+	p->length = length;
+}
+
+static int write_all(int fd, const uint8_t* p, size_t n)
+{
+	while (n > 0) {
+		const ssize_t w = write(fd, p, n);
+		if (w <= 0) return 0;
+		p += w;
+		n -= w;
+	}
+	return 1;
+}
+
+// returns 1 if a newer selection has replaced this job's
+static int extract_is_stale(struct extract_output* out, int generation)
+{
+	pthread_mutex_lock(&out->mutex);
+	const int is_stale = out->generation != generation;
+	pthread_mutex_unlock(&out->mutex);
+	return is_stale;
+}
+
+// copies at most EXTRACT_CHUNK bytes of the piece, from *in_off on. returns
+// the number copied, 0 on errors
+static size_t extract_piece_copy_chunk(int out_fd, const struct extract_piece* p, off_t* in_off, size_t n)
+{
+	if (n > EXTRACT_CHUNK) n = EXTRACT_CHUNK;
+	if (p->fd == -1) {
+		if (!write_all(out_fd, p->mem + *in_off, n)) return 0;
+		*in_off += n;
+		return n;
+	}
+	#if defined(__linux__) || defined(__FreeBSD__)
+	{
+		const ssize_t r = copy_file_range(p->fd, in_off, out_fd, NULL, n, 0);
+		if (r > 0) return r;
+		// e.g. EXDEV or out_fd being a pipe
+	}
+	#endif
+	#ifdef __linux__
+	{
+		const ssize_t r = sendfile(out_fd, p->fd, in_off, n);
+		if (r > 0) return r;
+	}
+	#endif
+
+	// fall back to copying through a mapping
+	const off_t page = sysconf(_SC_PAGESIZE);
+	const off_t map_off = *in_off - (*in_off % page);
+	const size_t map_len = n + (*in_off - map_off);
+	void* map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, p->fd, map_off);
+	if (map == MAP_FAILED) return 0;
+	madvise(map, map_len, MADV_SEQUENTIAL);
+	const int ok = write_all(out_fd, (const uint8_t*)map + (*in_off - map_off), n);
+	munmap(map, map_len);
+	if (!ok) return 0;
+	*in_off += n;
+	return n;
+}
+
+static void* extract_thread(void* usr)
+{
+	struct extract_output* out = usr;
+	const int to_stdout = strcmp(out->path, "-") == 0;
+	const int out_fd = to_stdout ? STDOUT_FILENO : open(out->path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if (out_fd == -1) fprintf(stderr, "%s: could not open for writing\n", out->path);
+	size_t total = 0; // since the last restart
+	for (;;) {
+		pthread_mutex_lock(&out->mutex);
+		while (out->head == NULL && !out->is_closing) pthread_cond_wait(&out->cond, &out->mutex);
+		struct extract_job* job = out->head;
+		if (job != NULL) {
+			out->head = job->next;
+			if (out->head == NULL) out->tail = NULL;
+		}
+		const int is_stale = job != NULL && job->generation != out->generation;
+		pthread_mutex_unlock(&out->mutex);
+		if (job == NULL) break;
+		if (out_fd == -1 || is_stale) {
+			extract_job_free(job);
+			continue;
+		}
+		if (job->is_restart) {
+			// a pipe can't be taken back; stdout just gets the new ranges
+			if (!to_stdout && (ftruncate(out_fd, 0) == -1 || lseek(out_fd, 0, SEEK_SET) == -1)) {
+				fprintf(stderr, "extract: could not truncate %s\n", out->path);
+			}
+			total = 0;
+		}
+		int ok = 1, is_superseded = 0;
+		for (int i = 0; ok && !is_superseded && i < job->n_pieces; i++) {
+			const struct extract_piece* p = &job->pieces[i];
+			off_t in_off = p->offset;
+			size_t remaining = p->length;
+			while (ok && remaining > 0) {
+				if (extract_is_stale(out, job->generation)) {
+					is_superseded = 1;
+					break;
+				}
+				const size_t n = extract_piece_copy_chunk(out_fd, p, &in_off, remaining);
+				if (n == 0) ok = 0;
+				remaining -= n;
+				total += n;
+			}
+		}
+		if (is_superseded) {
+			fprintf(stderr, "extract: %s superseded by a new selection after %zu bytes\n", out->path, total);
+		} else if (ok) {
+			fprintf(stderr, "extract: wrote %zu bytes to %s\n", total, out->path);
+		} else {
+			fprintf(stderr, "extract: failed writing %s (after %zu bytes)\n", out->path, total);
+		}
+		extract_job_free(job);
+	}
+	if (out_fd != -1 && !to_stdout) close(out_fd);
+	return NULL;
+}
+
+// hands the job to the output's writer; never waits for it
+static void extract_output_queue(struct extract_output* out, struct extract_job* job)
+{
+	if (!out->has_thread) {
+		if (pthread_create(&out->thread, NULL, extract_thread, out) != 0) {
+			fprintf(stderr, "could not create extract thread\n");
+			extract_job_free(job);
+			return;
+		}
+		out->has_thread = 1;
+	}
+	pthread_mutex_lock(&out->mutex);
+	if (job->is_restart) out->generation++;
+	job->generation = out->generation;
+	if (out->tail != NULL) {
+		out->tail->next = job;
+	} else {
+		out->head = job;
+	}
+	out->tail = job;
+	pthread_cond_signal(&out->cond);
+	pthread_mutex_unlock(&out->mutex);
+}
+
+// adds the pieces of each file overlapping [begin;end) of the concatenation
+static void input_set_extract(struct uncurl_input_set* set, struct extract_job* job, size_t begin, size_t end)
+{
+	for (int i = uncurl_input_set_find(set, begin); i < set->n_files; i++) {
+		struct uncurl_input_file* f = &set->files[i];
+		if (f->offset >= end) break;
+		const size_t b = begin > f->offset ? begin - f->offset : 0;
+		const size_t e = end - f->offset < f->size ? end - f->offset : f->size;
+		if (b >= e) continue; // only padding
+		if (f->fd == -1) f->fd = open(f->path, O_RDONLY);
+		if (f->fd == -1) {
+			fprintf(stderr, "%s: could not open\n", f->path);
+			continue;
+		}
+		extract_job_add_piece(job, f->fd, NULL, b, e-b);
+	}
+}
+
+// finishes the queued jobs (at exit) and frees the output
+static void extract_output_close(struct extract_output* out)
+{
+	if (out->has_thread) {
+		pthread_mutex_lock(&out->mutex);
+		out->is_closing = 1;
+		pthread_cond_signal(&out->cond);
+		pthread_mutex_unlock(&out->mutex);
+		pthread_join(out->thread, NULL);
+	}
+	pthread_mutex_destroy(&out->mutex);
+	pthread_cond_destroy(&out->cond);
+	free(out->path);
+	free(out);
+}
+
+// "uncurl d2xy|xy2d ..." converts between 1D coordinates and image x/y on
+// stdin/stdout, without touching SDL
+
+#define COORDS_BATCH (1<<18)
+#define COORDS_CHUNK (1<<13) // unit of work for uncurl_parallel_for()
+#define COORDS_MAX_TEXT (48) // "<u32> <u32>\n" or "<u64>\n" fits easily
+
+struct coords_text_reader {
+	FILE* in;
+	char buf[1<<16];
+	int pos, len;
+	int is_eof;
+};
+
+// reads the next unsigned integer, skipping anything that isn't a digit.
+// negative numbers and ones that don't fit in 64 bits read as UINT64_MAX,
+// which is out of range for any width, so they convert to -1
+static int coords_text_read(struct coords_text_reader* rd, uint64_t* out)
+{
+	int in_number = 0;
+	int is_negative = 0, is_overflow = 0;
+	uint64_t v = 0;
+	for (;;) {
+		if (rd->pos == rd->len) {
+			if (rd->is_eof) break;
+			rd->len = fread(rd->buf, 1, sizeof rd->buf, rd->in);
+			rd->pos = 0;
+			if (rd->len == 0) {
+				rd->is_eof = 1;
+				break;
+			}
+		}
+		const char c = rd->buf[rd->pos];
+		if ('0' <= c && c <= '9') {
+			if (v > (UINT64_MAX - (c-'0')) / 10) is_overflow = 1;
+			v = v*10 + (c-'0');
+			in_number = 1;
+		} else if (in_number) {
+			break;
+		} else {
+			is_negative = (c == '-');
+		}
+		rd->pos++;
+	}
+	*out = (is_negative || is_overflow) ? UINT64_MAX : v;
+	return in_number;
+}
+
+static char* coords_format(char* p, uint64_t v, int is_valid, char sep)
+{
+	if (!is_valid) {
+		*(p++) = '-';
+		*(p++) = '1';
+	} else {
+		char tmp[24];
+		int n = 0;
+		do {
+			tmp[n++] = '0' + (v % 10);
+			v /= 10;
+		} while (v > 0);
+		while (n > 0) *(p++) = tmp[--n];
+	}
+	*(p++) = sep;
+	return p;
+}
+
+struct coords_batch {
+	int is_d2xy, is_binary, width_log2;
+	int n;
+	uint64_t* ds;
+	uint32_t* xs;
+	uint32_t* ys;
+	uint32_t* xys;
+	uint8_t* valid;
+	char* text;
+	int* text_length; // per chunk
+};
+
+// converts (and formats) one chunk of a batch
+static void coords_batch_chunk(void* usr, int chunk)
+{
+	struct coords_batch* b = usr;
+	const int i0 = chunk * COORDS_CHUNK;
+	const int n = (b->n - i0) < COORDS_CHUNK ? (b->n - i0) : COORDS_CHUNK;
+	uint64_t* ds = b->ds + i0;
+	uint32_t* xs = b->xs + i0;
+	uint32_t* ys = b->ys + i0;
+	uint32_t* xys = b->xys + 2*i0;
+	uint8_t* valid = b->valid + i0;
+	const uint64_t n_points = (uint64_t)1 << (2*b->width_log2);
+	const uint32_t width_max = (uint32_t)(((uint64_t)1 << b->width_log2) - 1);
+
+	// out-of-range inputs are flagged; the kernels ignore the bits that
+	// make them out of range, so they're harmless to pass through
+	if (b->is_d2xy) {
+		for (int i = 0; i < n; i++) valid[i] = ds[i] < n_points;
+		uncurl_d2xy(b->width_log2, n, ds, xs, ys);
+		for (int i = 0; i < n; i++) {
+			if (!valid[i]) xs[i] = ys[i] = UINT32_MAX;
+		}
+	} else {
+		if (b->is_binary) {
+			for (int i = 0; i < n; i++) {
+				xs[i] = xys[2*i];
+				ys[i] = xys[2*i+1];
+			}
+		}
+		for (int i = 0; i < n; i++) valid[i] = xs[i] <= width_max && ys[i] <= width_max;
+		uncurl_xy2d(b->width_log2, n, xs, ys, ds);
+		for (int i = 0; i < n; i++) {
+			if (!valid[i]) ds[i] = UINT64_MAX;
+		}
+	}
+
+	if (b->is_binary) {
+		if (b->is_d2xy) {
+			for (int i = 0; i < n; i++) {
+				xys[2*i] = xs[i];
+				xys[2*i+1] = ys[i];
+			}
+		}
+		return;
+	}
+	char* text = b->text + (size_t)i0*COORDS_MAX_TEXT;
+	char* p = text;
+	for (int i = 0; i < n; i++) {
+		if (b->is_d2xy) {
+			p = coords_format(p, xs[i], valid[i], ' ');
+			p = coords_format(p, ys[i], valid[i], '\n');
+		} else {
+			p = coords_format(p, ds[i], valid[i], '\n');
+		}
+	}
+	b->text_length[chunk] = p - text;
+}
+
+static int coords_main(int argc, char** argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s d2xy|xy2d <WIDTH|input path> [binary]\n", argv[0]);
+		fprintf(stderr, "Converts between 1D coordinates and x/y on stdin/stdout.\n");
+		fprintf(stderr, "WIDTH must be a power of two; given an input path (or directory, glob,\n");
+		fprintf(stderr, "@list) the width is the one the viewer would pick for it.\n");
+		fprintf(stderr, "Text format: one coordinate (d2xy) or \"x y\" pair (xy2d) per line.\n");
+		fprintf(stderr, "Binary format (native endian): u64 coordinates, u32 x,u32 y pairs.\n");
+		fprintf(stderr, "Out-of-range values convert to -1 (text) or all bits set (binary).\n");
+		fprintf(stderr, "A truncated last record (a lone x, a partial binary one) is an error.\n");
+		exit(EXIT_FAILURE);
+	}
+	const int is_d2xy = strcmp(argv[1], "d2xy") == 0;
+	int is_binary = 0;
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "binary") == 0) {
+			is_binary = 1;
+		} else {
+			fprintf(stderr, "Invalid option: %s\n", argv[i]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	int width_log2 = -1;
+	size_t width;
+	if (strspn(argv[2], "0123456789") == strlen(argv[2]) && uncurl_parse_size(argv[2], &width)) {
+		for (int i = 0; i < 32; i++) if (((size_t)1 << i) == width) width_log2 = i;
+		if (width_log2 < 0) {
+			fprintf(stderr, "%s: width must be a power of two below 2^32\n", argv[2]);
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		struct uncurl_input_set set;
+		size_t size;
+		const int is_multi_file = uncurl_input_set_expand(&set, argv[2]);
+		if (is_multi_file < 0) {
+			fprintf(stderr, "%s\n", set.error);
+			exit(EXIT_FAILURE);
+		}
+		if (is_multi_file) {
+			size = set.total_size;
+		} else {
+			struct stat st;
+			if (stat(argv[2], &st) == -1) {
+				fprintf(stderr, "%s: could not stat\n", argv[2]);
+				exit(EXIT_FAILURE);
+			}
+			size = st.st_size;
+		}
+		width_log2 = uncurl_width_log2_for_length(size / N_COMP);
+		fprintf(stderr, "width: %zu\n", (size_t)1 << width_log2);
+	}
+	const int n_chunks = COORDS_BATCH / COORDS_CHUNK;
+	struct coords_batch b = {0};
+	b.is_d2xy = is_d2xy;
+	b.is_binary = is_binary;
+	b.width_log2 = width_log2;
+	b.ds = malloc(COORDS_BATCH * sizeof b.ds[0]);
+	b.xs = malloc(COORDS_BATCH * sizeof b.xs[0]);
+	b.ys = malloc(COORDS_BATCH * sizeof b.ys[0]);
+	b.xys = malloc(2*COORDS_BATCH * sizeof b.xys[0]);
+	b.valid = malloc(COORDS_BATCH);
+	b.text = is_binary ? NULL : malloc((size_t)COORDS_BATCH * COORDS_MAX_TEXT);
+	b.text_length = calloc(n_chunks, sizeof b.text_length[0]);
+	struct coords_text_reader* rd = calloc(1, sizeof *rd);
+	rd->in = stdin;
+
+	// a truncated last record is an error, reported once the records
+	// before it are written
+	const char* truncation = NULL;
+	while (truncation == NULL) {
+		// read a batch
+		int n = 0;
+		if (is_binary) {
+			// both records are 8 bytes; read bytes so a partial one is seen
+			uint8_t* buf = is_d2xy ? (uint8_t*)b.ds : (uint8_t*)b.xys;
+			const size_t n_bytes = fread(buf, 1, (size_t)COORDS_BATCH*8, stdin);
+			n = n_bytes / 8;
+			if (n_bytes % 8 != 0) truncation = is_d2xy ? "input ends in a partial u64 coordinate" : "input ends in a partial u32 x,y pair";
+		} else {
+			while (n < COORDS_BATCH) {
+				uint64_t x, y;
+				if (!coords_text_read(rd, &x)) break;
+				if (is_d2xy) {
+					b.ds[n++] = x;
+				} else {
+					if (!coords_text_read(rd, &y)) {
+						truncation = "input ends in an x without a y";
+						break;
+					}
+					b.xs[n] = x > UINT32_MAX ? UINT32_MAX : x;
+					b.ys[n] = y > UINT32_MAX ? UINT32_MAX : y;
+					n++;
+				}
+			}
+		}
+		if (n == 0) break;
+
+		b.n = n;
+		const int n_used_chunks = (n + COORDS_CHUNK - 1) / COORDS_CHUNK;
+		uncurl_parallel_for(n_used_chunks, coords_batch_chunk, &b);
+
+		// write the batch
+		if (is_binary && is_d2xy) {
+			fwrite(b.xys, 2*sizeof b.xys[0], n, stdout);
+		} else if (is_binary) {
+			fwrite(b.ds, sizeof b.ds[0], n, stdout);
+		} else {
+			for (int c = 0; c < n_used_chunks; c++) {
+				fwrite(b.text + (size_t)c*COORDS_CHUNK*COORDS_MAX_TEXT, 1, b.text_length[c], stdout);
+			}
+		}
+		if (ferror(stdout)) {
+			fprintf(stderr, "write error\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (truncation != NULL) {
+		fflush(stdout);
+		fprintf(stderr, "%s\n", truncation);
+		exit(EXIT_FAILURE);
+	}
+	free(rd);
+	return EXIT_SUCCESS;
+}
+
+// "uncurl flatten ..." is the inverse of the viewer's curl: it reads a
+// PPM/PAM image and writes its pixels out in curve order as an RGB stream
+
+#define FLATTEN_CHUNK_LOG2 (22) // points per output chunk
+
+struct netpbm_image {
+	int width, height, depth;
+	const uint8_t* pixels;
+};
+
+static const char* netpbm_token(const char* p, const char* end, char* out, int cap)
+{
+	for (;;) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+		if (p < end && *p == '#') {
+			while (p < end && *p != '\n') p++;
+			continue;
+		}
+		break;
+	}
+	int n = 0;
+	while (p < end && !(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+		if (n < cap-1) out[n++] = *p;
+		p++;
+	}
+	out[n] = 0;
+	return p;
+}
+
+// parses a binary PPM (P6) or PAM (P7) header with MAXVAL 255; the pixels
+// stay where they are
+static int netpbm_parse(const uint8_t* data, size_t size, struct netpbm_image* img)
+{
+	const char* p = (const char*)data;
+	const char* end = p + size;
+	char tok[64];
+	p = netpbm_token(p, end, tok, sizeof tok);
+	int maxval = 0;
+	if (strcmp(tok, "P6") == 0) {
+		p = netpbm_token(p, end, tok, sizeof tok);
+		img->width = atoi(tok);
+		p = netpbm_token(p, end, tok, sizeof tok);
+		img->height = atoi(tok);
+		p = netpbm_token(p, end, tok, sizeof tok);
+		maxval = atoi(tok);
+		img->depth = 3;
+		p++; // exactly one whitespace before the raster
+	} else if (strcmp(tok, "P7") == 0) {
+		for (;;) {
+			p = netpbm_token(p, end, tok, sizeof tok);
+			if (tok[0] == 0) return 0;
+			if (strcmp(tok, "ENDHDR") == 0) break;
+			char val[64];
+			p = netpbm_token(p, end, val, sizeof val);
+			if (strcmp(tok, "WIDTH") == 0) img->width = atoi(val);
+			if (strcmp(tok, "HEIGHT") == 0) img->height = atoi(val);
+			if (strcmp(tok, "DEPTH") == 0) img->depth = atoi(val);
+			if (strcmp(tok, "MAXVAL") == 0) maxval = atoi(val);
+		}
+		p++; // the newline after ENDHDR
+	} else {
+		return 0;
+	}
+	if (maxval != 255 || img->width <= 0 || img->height <= 0) return 0;
+	if (img->depth != 3 && img->depth != 4) return 0;
+	if (p > end || (size_t)(end-p) < (size_t)img->width * img->height * img->depth) return 0;
+	img->pixels = (const uint8_t*)p;
+	return 1;
+}
+
+static int flatten_main(int argc, char** argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s flatten <image.ppm|image.pam> [output] [size:<SIZE>]\n", argv[0]);
+		fprintf(stderr, "Writes the pixels of a square, power-of-two sized image in curve order as an\n");
+		fprintf(stderr, "RGB stream; the inverse of what the viewer draws. size:<SIZE> truncates the\n");
+		fprintf(stderr, "output to the original stream size. Output defaults to stdout.\n");
+		exit(EXIT_FAILURE);
+	}
+	const char* in_path = argv[2];
+	const char* out_path = "-";
+	size_t out_size = (size_t)-1;
+	for (int i = 3; i < argc; i++) {
+		const char* tail;
+		if (starts_with(argv[i], "size:", &tail)) {
+			if (!uncurl_parse_size(tail, &out_size)) {
+				fprintf(stderr, "Invalid size: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+		} else {
+			out_path = argv[i];
+		}
+	}
+
+	const uint8_t* data;
+	size_t size;
+	if (strcmp(in_path, "-") == 0) {
+		data = uncurl_read_entire_file(in_path, &size);
+		if (data == NULL) {
+			fprintf(stderr, "%s: could not read\n", in_path);
+			exit(EXIT_FAILURE);
+		}
 	} else {
-		in = fopen(path, "rb");
-		if (in == NULL) {
-			fprintf(stderr, "%s: could not open\n", path);
+		const int fd = open(in_path, O_RDONLY);
+		struct stat st;
+		if (fd == -1 || fstat(fd, &st) == -1) {
+			fprintf(stderr, "%s: could not open\n", in_path);
+			exit(EXIT_FAILURE);
+		}
+		size = st.st_size;
+		void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED) {
+			fprintf(stderr, "%s: could not mmap\n", in_path);
 			exit(EXIT_FAILURE);
 		}
+		close(fd);
+		data = map;
 	}
 
-	const size_t chunk_size = (1<<20);
-	uint8_t* data = NULL;
-	size_t n=0, cap=0;
-	for (;;) {
-		const size_t req_cap = n + chunk_size;
-		if (cap < req_cap) {
-			data = realloc(data, req_cap);
-			cap = req_cap;
+	struct netpbm_image img;
+	memset(&img, 0, sizeof img);
+	if (!netpbm_parse(data, size, &img)) {
+		fprintf(stderr, "%s: not a binary 8-bit RGB PPM or PAM image (or truncated)\n", in_path);
+		exit(EXIT_FAILURE);
+	}
+	int width_log2 = -1;
+	for (int i = 0; i < 31; i++) if ((1 << i) == img.width) width_log2 = i;
+	if (width_log2 < 0 || img.width != img.height) {
+		fprintf(stderr, "%s: image must be square with a power-of-two size (is %dx%d)\n", in_path, img.width, img.height);
+		exit(EXIT_FAILURE);
+	}
+
+	FILE* out = strcmp(out_path, "-") == 0 ? stdout : fopen(out_path, "wb");
+	if (out == NULL) {
+		fprintf(stderr, "%s: could not open for writing\n", out_path);
+		exit(EXIT_FAILURE);
+	}
+	const uint64_t n_points = (uint64_t)1 << (2*width_log2);
+	uint64_t remaining = out_size / N_COMP < n_points ? out_size / N_COMP : n_points;
+
+	const uint64_t chunk_points = n_points < ((uint64_t)1 << FLATTEN_CHUNK_LOG2) ? n_points : ((uint64_t)1 << FLATTEN_CHUNK_LOG2);
+	uint8_t* buf = malloc(chunk_points * N_COMP);
+	assert(buf != NULL);
+	const size_t stride = (size_t)img.width * img.depth;
+	for (uint64_t d0 = 0; remaining > 0; d0 += chunk_points) {
+		const uint64_t n = remaining < chunk_points ? remaining : chunk_points;
+		uncurl_flatten(img.pixels, width_log2, stride, img.depth, d0, n, buf);
+		if (fwrite(buf, N_COMP, n, out) != n) {
+			fprintf(stderr, "%s: write error\n", out_path);
+			exit(EXIT_FAILURE);
 		}
-		assert(data != NULL);
-		const size_t n_read = fread(data+n, 1, chunk_size, in);
-		n += n_read;
-		if (n_read < chunk_size) break;
+		remaining -= n;
 	}
-	if (out_size != NULL) *out_size = n;
-	return data;
+	if (out != stdout) fclose(out);
+	free(buf);
+	return EXIT_SUCCESS;
 }
 
-__attribute__ ((noreturn))
-static void SDL2FATAL(void)
-{
-	fprintf(stderr, "SDL2: %s\n", SDL_GetError());
-	exit(EXIT_FAILURE);
-}
+// "term" renders the view to the terminal instead of an SDL window, for
+// sessions without a display (e.g. over SSH). each character cell is a "▀"
+// with the upper pixel as foreground and the lower as background in 24-bit
+// color. zoomed out, pixels come from a pyramid of box-filtered reductions
+// built once up front; zoomed in, they're sampled from the (mapped) input
+// directly, so redraws cost the same on any input size. only cells that
+// changed since the previous frame are sent.
 
-#define EMIT_CURVE_TYPES \
-	X(hilbert)
+#define TERM_BASE_MAX_LOG2 (22) // max points in the finest precomputed reduction
 
-enum curve_type {
-	#define X(NAME) CURVE_TYPE_ ## NAME,
-	EMIT_CURVE_TYPES
-	#undef X
+struct term_cell {
+	uint8_t top[N_COMP];
+	uint8_t bottom[N_COMP];
 };
 
-static int starts_with(const char* s, const char* prefix, const char** out_tail)
+struct term_pyramid {
+	int width_log2;
+	int base_level; // levels between 0 and this aren't precomputed
+	const uint8_t* levels[32]; // levels[k] is the input reduced by 4^k
+	size_t n_points[32];
+};
+
+struct term_out {
+	char* buf;
+	size_t n, cap;
+};
+
+static struct termios term_saved;
+static int term_fd = -1;
+static volatile sig_atomic_t term_resized;
+
+static void term_restore(void)
 {
-	const size_t np = strlen(prefix);
-	if (strlen(s) >= np && memcmp(s, prefix, np) == 0) {
-		if (out_tail != NULL) *out_tail = s+np;
-		return 1;
-	} else {
-		return 0;
-	}
+	// reset colors, show cursor, leave the alternate screen
+	const char s[] = "\x1b[0m\x1b[?25h\x1b[?1049l";
+	if (write(STDOUT_FILENO, s, sizeof s - 1) < 0) {}
+	tcsetattr(term_fd, TCSAFLUSH, &term_saved);
 }
 
-static int window_width, window_height;
-static double pan_x = 0.0;
-static double pan_y = 0.0;
-static double scale = 1.0;
-
-static void map_screen_to_local(double sx, double sy, double* out_lx, double* out_ly)
+static void term_on_sigwinch(int sig)
 {
-	const double mid_x = (double)window_width * 0.5;
-	const double mid_y = (double)window_height * 0.5;
-	double lx = (sx - mid_x - pan_x) / scale;
-	double ly = (sy - mid_y - pan_y) / scale;
-	if (out_lx) *out_lx = lx;
-	if (out_ly) *out_ly = ly;
+	term_resized = 1;
 }
 
-struct lindenmayer_system_stack_entry {
-	int rule_index;
-	int pc;
-};
+static void term_append(struct term_out* o, const char* s, size_t n)
+{
+	if (o->n + n > o->cap) {
+		while (o->n + n > o->cap) o->cap = o->cap ? o->cap*2 : (1<<16);
+		o->buf = realloc(o->buf, o->cap);
+		assert(o->buf != NULL);
+	}
+	memcpy(o->buf + o->n, s, n);
+	o->n += n;
+}
 
-struct lindenmayer_system_rule {
-	const char* ops;
-	int length;
-};
+static void term_flush(struct term_out* o)
+{
+	size_t written = 0;
+	while (written < o->n) {
+		const ssize_t r = write(STDOUT_FILENO, o->buf + written, o->n - written);
+		if (r < 0) exit(EXIT_FAILURE);
+		written += r;
+	}
+	o->n = 0;
+}
 
-struct lindenmayer_system {
-	int n_rules;
-	struct lindenmayer_system_rule rules[1<<8];
-	int depth;
-	struct lindenmayer_system_stack_entry stack[1<<8];
-	int stack_height;
-	int state;
-	int x,y,direction;
-};
+static void term_pyramid_init(struct term_pyramid* py, const uint8_t* data, size_t n_points)
+{
+	memset(py, 0, sizeof *py);
+	py->width_log2 = uncurl_width_log2_for_length(n_points);
+	py->levels[0] = data;
+	py->n_points[0] = n_points;
+	while ((n_points >> (2*py->base_level)) > ((size_t)1 << TERM_BASE_MAX_LOG2)) py->base_level++;
+	if (py->base_level > 0) fprintf(stderr, "reducing %zu points...\n", n_points);
+	for (int k = py->base_level > 0 ? py->base_level : 1; k <= py->width_log2; k++) {
+		// reduce the base from the input, and each level after it from
+		// the one below
+		const int from = k == py->base_level ? 0 : k-1;
+		const int by = k - from;
+		const size_t block = (size_t)1 << (2*by);
+		py->n_points[k] = (py->n_points[from] + block - 1) / block;
+		uint8_t* level = malloc(py->n_points[k] * N_COMP);
+		assert(level != NULL);
+		uncurl_reduce(py->levels[from], py->n_points[from], by, level);
+		py->levels[k] = level;
+	}
+}
 
-static void lindenmayer_system_init(struct lindenmayer_system* lsys, int n_rules, const char** rules, int depth)
+// samples one screen row; level is the pyramid level matching the zoom
+static void term_sample_row(const struct term_pyramid* py, int level, double lx0, double dx, double ly, int n, uint8_t* out)
 {
-	assert(n_rules <= ARRAY_LENGTH(lsys->rules));
-	memset(lsys, 0, sizeof *lsys);
-	lsys->depth = depth;
-	lsys->n_rules = n_rules;
-	for (int i = 0; i < n_rules; i++) {
-		struct lindenmayer_system_rule* rule = &lsys->rules[i];
-		rule->ops = strdup(rules[i]);
-		rule->length = strlen(rule->ops);
+	memset(out, 0, (size_t)n*N_COMP);
+	const int width = 1 << py->width_log2;
+	if (!(0 <= ly && ly < width)) return;
+	if (level < py->base_level) level = 0;
+	const int width_log2 = py->width_log2 - level;
+	uint32_t xs[1<<10], ys[1<<10];
+	uint64_t ds[1<<10];
+	int cols[1<<10];
+	int m = 0;
+	for (int i = 0; i < n && m < ARRAY_LENGTH(xs); i++) {
+		const double lx = lx0 + i*dx;
+		if (!(0 <= lx && lx < width)) continue;
+		xs[m] = (uint32_t)lx >> level;
+		ys[m] = (uint32_t)ly >> level;
+		cols[m] = i;
+		m++;
+	}
+	if (m == 0) return;
+	uncurl_xy2d(width_log2, m, xs, ys, ds);
+	const uint8_t* src = py->levels[level];
+	for (int j = 0; j < m; j++) {
+		if (ds[j] >= py->n_points[level]) continue;
+		memcpy(&out[(size_t)cols[j]*N_COMP], &src[ds[j]*N_COMP], N_COMP);
 	}
 }
 
-static int lindenmayer_system_next_coord(struct lindenmayer_system* lsys, int* out_x, int* out_y)
+static int term_main(const uint8_t* data, size_t input_length)
 {
-	if (lsys->state >= 2) return 0;
-	if (lsys->state == 0) {
-		// it's awkward to emit either the first or last point
-		if (out_x) *out_x = 0;
-		if (out_y) *out_y = 0;
-		lsys->stack_height = 1;
-		lsys->stack[0].rule_index = 0;
-		lsys->stack[0].pc = 0;
-		lsys->state = 1;
-		return 1;
+	if (!isatty(STDOUT_FILENO)) {
+		fprintf(stderr, "term: stdout is not a terminal\n");
+		exit(EXIT_FAILURE);
+	}
+	// keys come from the terminal even when the data comes from stdin
+	term_fd = open("/dev/tty", O_RDWR);
+	if (term_fd == -1 || tcgetattr(term_fd, &term_saved) == -1) {
+		fprintf(stderr, "term: no controlling terminal\n");
+		exit(EXIT_FAILURE);
 	}
-	assert(lsys->state == 1);
+
+	struct term_pyramid py;
+	term_pyramid_init(&py, data, input_length);
+	const int width = 1 << py.width_log2;
+
+	struct termios raw = term_saved;
+	cfmakeraw(&raw);
+	tcsetattr(term_fd, TCSAFLUSH, &raw);
+	atexit(term_restore);
+	signal(SIGWINCH, term_on_sigwinch);
+
+	struct term_out o = {0};
+	const char enter[] = "\x1b[?1049h\x1b[?25l";
+	term_append(&o, enter, sizeof enter - 1);
+
+	int cols = 0, rows = 0;
+	struct term_cell* cells = NULL;
+	uint8_t* row_pixels[2] = {NULL, NULL};
+	char status[256] = {0};
+	double t_pan_x = 0.0, t_pan_y = 0.0, t_scale = 0.0;
+	int is_dirty = 1;
+	int is_full = 1;
+	term_resized = 1;
 	for (;;) {
-		if (lsys->stack_height == 0) {
-			lsys->state = 2;
-			return 0;
+		if (term_resized) {
+			term_resized = 0;
+			struct winsize ws;
+			if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1 || ws.ws_col == 0 || ws.ws_row < 2) {
+				ws.ws_col = 80;
+				ws.ws_row = 24;
+			}
+			const int fit = t_scale == 0.0;
+			cols = ws.ws_col;
+			rows = ws.ws_row - 1; // last row is the status line
+			cells = realloc(cells, (size_t)cols*rows * sizeof cells[0]);
+			for (int i = 0; i < 2; i++) row_pixels[i] = realloc(row_pixels[i], (size_t)cols*N_COMP);
+			assert(cells != NULL && row_pixels[0] != NULL && row_pixels[1] != NULL);
+			const char clear[] = "\x1b[0m\x1b[2J";
+			term_append(&o, clear, sizeof clear - 1);
+			status[0] = 0;
+			if (fit) t_scale = (double)(cols < 2*rows ? cols : 2*rows) / width;
+			is_dirty = 1;
+			is_full = 1;
 		}
-		struct lindenmayer_system_stack_entry* e = &lsys->stack[lsys->stack_height-1];
-		assert(0 <= e->rule_index && e->rule_index < lsys->n_rules);
-		struct lindenmayer_system_rule* rule = &lsys->rules[e->rule_index];
-		if (e->pc >= rule->length) {
-			lsys->stack_height--;
-			if (lsys->stack_height > 0) {
-				lsys->stack[lsys->stack_height-1].pc++;
+
+		if (is_dirty) {
+			is_dirty = 0;
+			const int screen_h = 2*rows;
+			int level = 0;
+			while (level < py.width_log2 && ((double)(2 << level) * t_scale) <= 1.0) level++;
+			const double dx = 1.0 / t_scale;
+			const double lx0 = (0.5 - cols*0.5 - t_pan_x) / t_scale + width*0.5;
+			int cur_x = -1, cur_y = -1;
+			int fg = -1, bg = -1;
+			char tmp[64];
+			for (int cy = 0; cy < rows; cy++) {
+				for (int i = 0; i < 2; i++) {
+					const double ly = (2*cy + i + 0.5 - screen_h*0.5 - t_pan_y) / t_scale + width*0.5;
+					term_sample_row(&py, level, lx0, dx, ly, cols, row_pixels[i]);
+				}
+				for (int cx = 0; cx < cols; cx++) {
+					struct term_cell cell;
+					memcpy(cell.top, &row_pixels[0][cx*N_COMP], N_COMP);
+					memcpy(cell.bottom, &row_pixels[1][cx*N_COMP], N_COMP);
+					struct term_cell* prev = &cells[cy*cols + cx];
+					if (!is_full && memcmp(prev, &cell, sizeof cell) == 0) continue;
+					*prev = cell;
+					if (cur_x != cx || cur_y != cy) {
+						term_append(&o, tmp, snprintf(tmp, sizeof tmp, "\x1b[%d;%dH", cy+1, cx+1));
+					}
+					const int cfg = (cell.top[0]<<16) | (cell.top[1]<<8) | cell.top[2];
+					const int cbg = (cell.bottom[0]<<16) | (cell.bottom[1]<<8) | cell.bottom[2];
+					if (cfg != fg) {
+						term_append(&o, tmp, snprintf(tmp, sizeof tmp, "\x1b[38;2;%d;%d;%dm", cell.top[0], cell.top[1], cell.top[2]));
+						fg = cfg;
+					}
+					if (cbg != bg) {
+						term_append(&o, tmp, snprintf(tmp, sizeof tmp, "\x1b[48;2;%d;%d;%dm", cell.bottom[0], cell.bottom[1], cell.bottom[2]));
+						bg = cbg;
+					}
+					term_append(&o, "\xe2\x96\x80", 3);
+					cur_x = cx+1;
+					cur_y = cy;
+				}
 			}
-			continue;
+
+			is_full = 0;
+
+			// status line: the byte offset at the center of the screen
+			char new_status[256];
+			const double cx_l = -t_pan_x / t_scale + width*0.5;
+			const double cy_l = -t_pan_y / t_scale + width*0.5;
+			uint64_t d = (uint64_t)-1;
+			if (0 <= cx_l && cx_l < width && 0 <= cy_l && cy_l < width) {
+				const uint32_t x = cx_l, y = cy_l;
+				uncurl_xy2d(py.width_log2, 1, &x, &y, &d);
+			}
+			if (d < input_length) {
+				snprintf(new_status, sizeof new_status, " offset %llu (0x%llx)  1:%d  [arrows/hjkl] pan  [+/-] zoom  [0] fit  [q] quit",
+					(unsigned long long)d*N_COMP, (unsigned long long)d*N_COMP, 1 << level);
+			} else {
+				snprintf(new_status, sizeof new_status, " -  1:%d  [arrows/hjkl] pan  [+/-] zoom  [0] fit  [q] quit", 1 << level);
+			}
+			if (strcmp(new_status, status) != 0) {
+				strcpy(status, new_status);
+				term_append(&o, tmp, snprintf(tmp, sizeof tmp, "\x1b[0m\x1b[%d;1H", rows+1));
+				term_append(&o, status, strlen(status) < (size_t)cols ? strlen(status) : (size_t)cols);
+				term_append(&o, "\x1b[K", 3);
+			}
+			term_flush(&o);
 		}
-		assert(e->pc < rule->length);
-		char op = rule->ops[e->pc];
-		int new_rule_index = -1;
-		int did_emit = 0;
-		switch (op) {
-		case '^': {
-			switch (lsys->direction) {
-			case 0: lsys->x++; break;
-			case 1: lsys->y++; break;
-			case 2: lsys->x--; break;
-			case 3: lsys->y--; break;
-			default: assert(!"bad state");
-			}
-			if (out_x) *out_x = lsys->x;
-			if (out_y) *out_y = lsys->y;
-			did_emit = 1;
-		}	break;
-		case '+': {
-			lsys->direction = (lsys->direction + 1) & 3;
-		}	break;
-		case '-': {
-			lsys->direction = (lsys->direction + 3) & 3;
-		}	break;
-		default: {
-			assert('0' <= op && op <= '9');
-			new_rule_index = op - '0';
-		}	break;
-		}
-		if (new_rule_index >= 0 && lsys->stack_height < lsys->depth) {
-			assert(lsys->stack_height < ARRAY_LENGTH(lsys->stack));
-			lsys->stack[lsys->stack_height].rule_index = new_rule_index;
-			lsys->stack[lsys->stack_height].pc = 0;
-			lsys->stack_height++;
-		} else {
-			assert(lsys->stack_height > 0);
-			lsys->stack[lsys->stack_height-1].pc++;
+
+		struct pollfd pfd = { .fd = term_fd, .events = POLLIN };
+		if (poll(&pfd, 1, -1) <= 0) continue; // EINTR on resize
+		char keys[256];
+		const ssize_t n = read(term_fd, keys, sizeof keys);
+		if (n <= 0) continue;
+		// handle everything that's queued up before redrawing; with key
+		// repeat over a slow link this skips the frames in between
+		for (int i = 0; i < n; i++) {
+			int key = keys[i];
+			if (key == 0x1b) {
+				if (i+2 < n && (keys[i+1] == '[' || keys[i+1] == 'O')) {
+					switch (keys[i+2]) {
+					case 'A': key = 'k'; break;
+					case 'B': key = 'j'; break;
+					case 'C': key = 'l'; break;
+					case 'D': key = 'h'; break;
+					default: key = 0; break;
+					}
+					i += 2;
+				} else if (n == 1) {
+					key = 'q'; // a lone ESC
+				}
+			}
+			const double step_x = cols / 8.0 > 1.0 ? cols / 8.0 : 1.0;
+			const double step_y = rows / 4.0 > 1.0 ? rows / 4.0 : 1.0;
+			switch (key) {
+			case 'q': case 3: exit(EXIT_SUCCESS);
+			case 'h': t_pan_x += step_x; break;
+			case 'l': t_pan_x -= step_x; break;
+			case 'k': t_pan_y += step_y; break;
+			case 'j': t_pan_y -= step_y; break;
+			case '+': case '=':
+				t_scale *= 2.0;
+				t_pan_x *= 2.0;
+				t_pan_y *= 2.0;
+				break;
+			case '-': case '_':
+				t_scale *= 0.5;
+				t_pan_x *= 0.5;
+				t_pan_y *= 0.5;
+				break;
+			case '0':
+				t_scale = (double)(cols < 2*rows ? cols : 2*rows) / width;
+				t_pan_x = t_pan_y = 0.0;
+				break;
+			default: continue;
+			}
+			is_dirty = 1;
 		}
-		if (did_emit) return 1;
 	}
 }
 
 int main(int argc, char** argv)
 {
+	if (argc >= 2 && (strcmp(argv[1], "d2xy") == 0 || strcmp(argv[1], "xy2d") == 0)) {
+		return coords_main(argc, argv);
+	}
+	if (argc >= 2 && strcmp(argv[1], "flatten") == 0) {
+		return flatten_main(argc, argv);
+	}
+
 	if (argc < 2) {
-		fprintf(stderr, "Usage: %s <input path> [option]...\n", argv[0]);
+		fprintf(stderr, "Usage: %s <input path|directory|glob|@list> [option]...\n", argv[0]);
+		fprintf(stderr, "       %s d2xy|xy2d <WIDTH|input path> [binary]   (coordinate conversion)\n", argv[0]);
+		fprintf(stderr, "       %s flatten <image.ppm|image.pam> [output] [size:<SIZE>]   (image to stream)\n", argv[0]);
 		assert((N_COMP == 3) && "usage text is lying now?");
 		fprintf(stderr, "Input data must be an RGB byte stream, 3 bytes per pixel (R0,G0,B0,R1,G1,...)\n");
 		fprintf(stderr, "Options:\n");
 		fprintf(stderr, "  exit            Exit program on click\n");
 		fprintf(stderr, "  write:<PATH>    Write 1D coordinate to file on click\n");
 		fprintf(stderr, "  clipboard       Write 1D coordinate to clipboard on click\n");
+		fprintf(stderr, "  extract:<PATH>  Copy the bytes of the range dragged out with LMB to file\n");
+		fprintf(stderr, "  frames:<SIZE>   Play input back as a sequence of SIZE byte frames (e.g. 64M)\n");
+		fprintf(stderr, "  frame:<PATH>    Append frames from another file (with frames:<SIZE>)\n");
+		fprintf(stderr, "  fps:<N>         Frame-sequence playback rate (default: 30)\n");
+		fprintf(stderr, "  delta           Only upload blocks that changed since previous frame\n");
+		fprintf(stderr, "  window:<SIZE>   Scrub a SIZE byte window through the input (e.g. 64M)\n");
+		fprintf(stderr, "  term            Render in the terminal (24-bit color) instead of a window\n");
+		fprintf(stderr, "  overview        Show a sampled overview at once, then refine it while loading\n");
+		fprintf(stderr, "                  (the default for inputs over %zuM)\n", ((size_t)N_COMP << (2*OVERVIEW_AUTO_LOG2)) >> 20);
+		fprintf(stderr, "  control:<PATH>  Take commands (open, goto, zoom, highlight, find, query) on a Unix socket\n");
+		fprintf(stderr, "  record:<SIZE>   Input is SIZE byte records (up to %d), projected to RGB\n", UNCURL_RECORD_MAX);
+		fprintf(stderr, "  project:<TYPE>  Projection for record:<SIZE>; pca (default) or random\n");
+		fprintf(stderr, "  palette:<NAME>  Input is bytes, one per point, colored by class, gray or heat\n");
+		fprintf(stderr, "  pointers        Find the pointers in an ELF core dump and draw where they go\n");
+		fprintf(stderr, "  pointers:<ADDR> Likewise for a raw dump of memory starting at address ADDR\n");
+		fprintf(stderr, "  compress        Color each block of the input by how well it compresses; also\n");
+		fprintf(stderr, "                  compress:<SIZE> for blocks other than %d bytes (results are cached)\n", COMPRESS_DEFAULT_BLOCK);
+		fprintf(stderr, "  strings         Find printable strings, like strings(1); also strings:<MIN> (default: %d)\n", STRINGS_DEFAULT_MIN);
+		fprintf(stderr, "  find:<QUERY>    Tint the values of a type in a range: <TYPE>[@<ALIGN>]:<LO>[:<HI>],\n");
+		fprintf(stderr, "                  TYPE being u8-u64, i8-i64, f32 or f64 (+be for big-endian)\n");
+		fprintf(stderr, "  green:<PATH>    With blue:<PATH>, draw three inputs of one byte per point as the\n");
+		fprintf(stderr, "  blue:<PATH>     red, green and blue of one view (the input is red)\n");
 		// NOTE insert+fix usage if I ever get more than one curve type
 		//fprintf(stderr, "  curve:<TYPE>    Select curve type (default: hilbert)\n");
 		fprintf(stderr, "HINT: you can add any number of click action options.\n");
 		fprintf(stderr, "HINT: \"-\" works as path for both input (stdin) and output (stdout)\n");
-		fprintf(stderr, "HINT: you can pan+zoom with RMB+mouse wheel\n");
+		fprintf(stderr, "HINT: directories, globs and @<list file> inputs are concatenated along the curve;\n");
+		fprintf(stderr, "      clicks then also write file and offset, and B toggles file boundaries\n");
+		fprintf(stderr, "HINT: you can pan+zoom with RMB+mouse wheel; zoomed in, cells get hex labels (L toggles)\n");
+		fprintf(stderr, "HINT: P toggles an overlay of the curve's path\n");
+		fprintf(stderr, "HINT: ELF files (binaries, cores) get their segments overlaid (E toggles); clicks\n");
+		fprintf(stderr, "      then also write file offset, virtual address and section\n");
+		fprintf(stderr, "HINT: pointers: lines go from the cells under the cursor (and in the selection)\n");
+		fprintf(stderr, "      to what they point at, once the scan is done; G toggles\n");
+		fprintf(stderr, "HINT: strings: hovering over one shows it in the title, and clicks write it too;\n");
+		fprintf(stderr, "      T toggles the tint on the cells with strings in them\n");
+		fprintf(stderr, "HINT: S splits the window into two views of the same data; Z links their zoom\n");
+		fprintf(stderr, "HINT: extract: hold CTRL while dragging to add more ranges to the selection\n");
+		fprintf(stderr, "HINT: frames: SPACE plays/pauses, LEFT/RIGHT steps, PAGEUP/PAGEDOWN seeks, HOME/END\n");
+		fprintf(stderr, "      a core curls about 200M pixels a second, so frames up to 12M (2048 wide) play\n");
+		fprintf(stderr, "      at 30 fps on one core, up to 48M (4096 wide) need about 3 cores and up to\n");
+		fprintf(stderr, "      192M (8192 wide, e.g. 64M frames) about 10; with fewer, playback slows down\n");
+		fprintf(stderr, "HINT: window: drag the slider or hold LEFT/RIGHT (+SHIFT for faster) to scrub\n");
+		fprintf(stderr, "HINT: term: arrows/hjkl pan, +/- zoom, 0 fits, q quits; works over SSH\n");
+		fprintf(stderr, "HINT: record: each channel is one direction through the records (the principal\n");
+		fprintf(stderr, "      components of a sample for pca); clicks write the record index\n");
+		fprintf(stderr, "HINT: palette, compress: C cycles the palettes\n");
+		fprintf(stderr, "HINT: find: e.g. find:u32:0x1000:0x1fff, find:i16be@1:-5:5 or find:f64:nan; the\n");
+		fprintf(stderr, "      title counts the hits in view, and F toggles the tint\n");
+		fprintf(stderr, "HINT: green, blue: shorter inputs are black in their channel past their end\n");
+		fprintf(stderr, "HINT: control: one command per line, e.g. $ echo 'goto 0x1000' | nc -U <PATH>\n");
+		fprintf(stderr, "      inputs opened with \"open <input>\" load in the background (the reply is\n");
+		fprintf(stderr, "      \"ok loading\"; repeat to poll) and stay loaded, so reopening is instant\n");
 		fprintf(stderr, "Example:\n");
 		fprintf(stderr, "$ python make_test_data.py uncurl - | ./uncurl - write:- exit\n");
 		fprintf(stderr, "It uses the make_test_data.py script to convert the uncurl binary into something\n");
@@ -224,9 +4124,31 @@ int main(int argc, char** argv)
 	// parse options
 	int exit_on_click = 0;
 	int copy_to_clipboard_on_click = 0;
-	enum curve_type curve_type = CURVE_TYPE_hilbert;
+	enum uncurl_curve_type curve_type = UNCURL_CURVE_TYPE_hilbert;
 	const char* output_paths[256];
 	int n_output_paths = 0;
+	size_t frame_size = 0;
+	const char* frame_paths[256];
+	int n_frame_paths = 0;
+	double fps = 30.0;
+	int use_delta = 0;
+	size_t scrub_window = 0;
+	int use_term = 0;
+	int use_overview = 0;
+	const char* control_path = NULL;
+	size_t record_size = 0;
+	enum uncurl_projection_type projection = UNCURL_PROJECTION_PCA;
+	int palette = -1;
+	int use_pointers = 0, has_pointer_base = 0;
+	unsigned long long pointer_base = 0;
+	size_t strings_min = 0;
+	size_t compress_block = 0;
+	const char* green_path = NULL;
+	const char* blue_path = NULL;
+	const char* find_text = NULL;
+	struct uncurl_value_query find_query = {0};
+	struct extract_output* extract_outputs[256];
+	int n_extract_paths = 0;
 	for (int i = 2; i < argc; i++) {
 		const char* option = argv[i];
 		const char* tail = NULL;
@@ -237,14 +4159,101 @@ int main(int argc, char** argv)
 		} else if (starts_with(option, "write:", &tail)) {
 			assert((n_output_paths < ARRAY_LENGTH(output_paths)) && "my that's a lot of outputs!");
 			output_paths[n_output_paths++] = strdup(tail);
+		} else if (starts_with(option, "extract:", &tail)) {
+			assert((n_extract_paths < ARRAY_LENGTH(extract_outputs)) && "my that's a lot of outputs!");
+			extract_outputs[n_extract_paths++] = extract_output_new(tail);
+		} else if (starts_with(option, "frames:", &tail)) {
+			if (!uncurl_parse_size(tail, &frame_size) || frame_size == 0 || (frame_size % N_COMP) != 0) {
+				fprintf(stderr, "Invalid frame size: %s (must be a multiple of %d)\n", tail, N_COMP);
+				exit(EXIT_FAILURE);
+			}
+		} else if (starts_with(option, "frame:", &tail)) {
+			assert((n_frame_paths < ARRAY_LENGTH(frame_paths)) && "my that's a lot of frame files!");
+			frame_paths[n_frame_paths++] = strdup(tail);
+		} else if (starts_with(option, "fps:", &tail)) {
+			fps = atof(tail);
+			if (fps <= 0.0) {
+				fprintf(stderr, "Invalid fps: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp("delta", option) == 0) {
+			use_delta = 1;
+		} else if (starts_with(option, "window:", &tail)) {
+			if (!uncurl_parse_size(tail, &scrub_window) || scrub_window < N_COMP) {
+				fprintf(stderr, "Invalid window size: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp("term", option) == 0) {
+			use_term = 1;
+		} else if (strcmp("overview", option) == 0) {
+			use_overview = 1;
+		} else if (strcmp("compress", option) == 0) {
+			compress_block = COMPRESS_DEFAULT_BLOCK;
+		} else if (starts_with(option, "compress:", &tail)) {
+			if (!uncurl_parse_size(tail, &compress_block) || compress_block < 16 || compress_block > UNCURL_COMPRESS_BLOCK_MAX) {
+				fprintf(stderr, "Invalid block size: %s (16 to %d)\n", tail, UNCURL_COMPRESS_BLOCK_MAX);
+				exit(EXIT_FAILURE);
+			}
+		} else if (starts_with(option, "find:", &tail)) {
+			if (!values_parse(tail, &find_query)) {
+				fprintf(stderr, "Invalid query: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+			find_text = strdup(tail);
+		} else if (starts_with(option, "green:", &tail)) {
+			green_path = strdup(tail);
+		} else if (starts_with(option, "blue:", &tail)) {
+			blue_path = strdup(tail);
+		} else if (strcmp("strings", option) == 0) {
+			strings_min = STRINGS_DEFAULT_MIN;
+		} else if (starts_with(option, "strings:", &tail)) {
+			if (!uncurl_parse_size(tail, &strings_min) || strings_min == 0) {
+				fprintf(stderr, "Invalid minimum string length: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp("pointers", option) == 0) {
+			use_pointers = 1;
+		} else if (starts_with(option, "pointers:", &tail)) {
+			char* end;
+			pointer_base = strtoull(tail, &end, 0);
+			if (*tail == 0 || *end != 0) {
+				fprintf(stderr, "Invalid address: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+			use_pointers = 1;
+			has_pointer_base = 1;
+		} else if (starts_with(option, "control:", &tail)) {
+			control_path = strdup(tail);
+		} else if (starts_with(option, "record:", &tail)) {
+			if (!uncurl_parse_size(tail, &record_size) || record_size == 0 || record_size > UNCURL_RECORD_MAX) {
+				fprintf(stderr, "Invalid record size: %s (at most %d)\n", tail, UNCURL_RECORD_MAX);
+				exit(EXIT_FAILURE);
+			}
+		} else if (starts_with(option, "palette:", &tail)) {
+			for (int k = 0; k < N_PALETTES; k++) {
+				if (strcmp(palette_names[k], tail) == 0) palette = k;
+			}
+			if (palette < 0) {
+				fprintf(stderr, "Invalid palette: %s\n", tail);
+				exit(EXIT_FAILURE);
+			}
+		} else if (starts_with(option, "project:", &tail)) {
+			if (strcmp(tail, "pca") == 0) {
+				projection = UNCURL_PROJECTION_PCA;
+			} else if (strcmp(tail, "random") == 0) {
+				projection = UNCURL_PROJECTION_RANDOM;
+			} else {
+				fprintf(stderr, "Invalid projection: %s (pca or random)\n", tail);
+				exit(EXIT_FAILURE);
+			}
 		} else if (starts_with(option, "curve:", &tail)) {
 			int found = 0;
 			#define X(NAME) \
 				if (!found && strcmp(#NAME, tail) == 0) { \
 					found=1; \
-					curve_type = CURVE_TYPE_ ## NAME; \
+					curve_type = UNCURL_CURVE_TYPE_ ## NAME; \
 				}
-			EMIT_CURVE_TYPES
+			UNCURL_EMIT_CURVE_TYPES
 			#undef X
 			if (!found) {
 				fprintf(stderr, "Invalid curve type: %s\n", tail);
@@ -256,14 +4265,140 @@ int main(int argc, char** argv)
 		}
 	}
 
-	size_t raw_input_data_size;
-	uint8_t* data = read_entire_file(argv[1], &raw_input_data_size);
-	assert(data != NULL);
-	if ((raw_input_data_size % N_COMP) != 0) {
-		fprintf(stderr, "%s: number of bytes must be a multiple of %d\n", argv[1], N_COMP);
+	if (n_frame_paths > 0 && frame_size == 0) {
+		fprintf(stderr, "frame:<PATH> requires frames:<SIZE>\n");
+		exit(EXIT_FAILURE);
+	}
+	if (frame_size > 0 && scrub_window > 0) {
+		fprintf(stderr, "frames:<SIZE> and window:<SIZE> are mutually exclusive\n");
+		exit(EXIT_FAILURE);
+	}
+	if (use_term && (frame_size > 0 || scrub_window > 0)) {
+		fprintf(stderr, "term doesn't do frames:<SIZE> or window:<SIZE>\n");
+		exit(EXIT_FAILURE);
+	}
+	if (use_overview && (frame_size > 0 || scrub_window > 0)) {
+		fprintf(stderr, "overview doesn't do frames:<SIZE> or window:<SIZE>\n");
+		exit(EXIT_FAILURE);
+	}
+	if (record_size > 0 && (frame_size > 0 || scrub_window > 0 || use_term || use_overview)) {
+		fprintf(stderr, "record:<SIZE> doesn't do frames:<SIZE>, window:<SIZE>, term or overview\n");
+		exit(EXIT_FAILURE);
+	}
+	if (compress_block > 0 && (frame_size > 0 || scrub_window > 0 || use_term || use_overview || record_size > 0)) {
+		fprintf(stderr, "compress doesn't do frames:<SIZE>, window:<SIZE>, term, overview or record:<SIZE>\n");
 		exit(EXIT_FAILURE);
 	}
-	const size_t input_length = raw_input_data_size / N_COMP;
+	if (palette >= 0 && (frame_size > 0 || scrub_window > 0 || use_term || use_overview || record_size > 0)) {
+		fprintf(stderr, "palette:<NAME> doesn't do frames:<SIZE>, window:<SIZE>, term, overview or record:<SIZE>\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((green_path != NULL) != (blue_path != NULL)) {
+		fprintf(stderr, "green:<PATH> and blue:<PATH> go together\n");
+		exit(EXIT_FAILURE);
+	}
+	if (green_path != NULL && (frame_size > 0 || scrub_window > 0 || use_term || use_overview || record_size > 0 || palette >= 0 || compress_block > 0 || use_pointers || n_extract_paths > 0)) {
+		fprintf(stderr, "green:<PATH> and blue:<PATH> don't do frames:<SIZE>, window:<SIZE>, term, overview,\n");
+		fprintf(stderr, "record:<SIZE>, palette:<NAME>, compress, pointers or extract:<PATH>\n");
+		exit(EXIT_FAILURE);
+	}
+	if (use_pointers && (frame_size > 0 || use_term)) {
+		fprintf(stderr, "pointers doesn't do frames:<SIZE> or term\n");
+		exit(EXIT_FAILURE);
+	}
+	if (strings_min > 0 && (frame_size > 0 || use_term)) {
+		fprintf(stderr, "strings doesn't do frames:<SIZE> or term\n");
+		exit(EXIT_FAILURE);
+	}
+	if (find_text != NULL && (frame_size > 0 || use_term)) {
+		fprintf(stderr, "find:<QUERY> doesn't do frames:<SIZE> or term\n");
+		exit(EXIT_FAILURE);
+	}
+	const struct doc_options doc_opt = {
+		.use_overview = use_overview,
+		.record_size = record_size,
+		.projection = projection,
+		.is_bytes = palette >= 0 && compress_block == 0,
+		.use_pointers = use_pointers,
+		.has_pointer_base = has_pointer_base,
+		.pointer_base = pointer_base,
+		.strings_min = strings_min,
+		.compress_block = compress_block,
+		.green_path = green_path,
+		.blue_path = blue_path,
+		.find_text = find_text,
+		.find_query = find_query,
+	};
+	if (palette < 0) palette = compress_block > 0 ? PALETTE_heat : PALETTE_class;
+	palettes_init();
+
+	struct uncurl_input_set inputs;
+	int is_multi_file = uncurl_input_set_expand(&inputs, argv[1]);
+	if (is_multi_file < 0) {
+		fprintf(stderr, "%s\n", inputs.error);
+		exit(EXIT_FAILURE);
+	}
+
+	if (use_term) {
+		// mapped rather than read; the input may well be bigger than memory
+		const uint8_t* term_data;
+		size_t term_size;
+		if (is_multi_file) {
+			term_data = uncurl_input_set_read(&inputs);
+			if (term_data == NULL) {
+				fprintf(stderr, "%s\n", inputs.error);
+				exit(EXIT_FAILURE);
+			}
+			term_size = inputs.total_size;
+		} else {
+			term_data = map_entire_file(argv[1], &term_size);
+		}
+		return term_main(term_data, term_size / N_COMP);
+	}
+
+	struct doc* docs[DOC_MAX];
+	int n_docs = 0;
+	struct doc* doc = NULL;
+	struct doc_loader* loader = NULL; // control "open" in progress
+	char* loader_path = NULL;
+	char* failed_path = NULL; // the last failed "open", until it's reported
+	uint8_t* data = NULL;
+	size_t input_length;
+	struct player* player = NULL;
+	struct scrub* scrub = NULL;
+	struct overview* overview = NULL;
+	if (scrub_window > 0) {
+		if (is_multi_file) {
+			fprintf(stderr, "window:<SIZE> needs a single input file\n");
+			exit(EXIT_FAILURE);
+		}
+		scrub = calloc(1, sizeof *scrub);
+		scrub_open(scrub, argv[1], scrub_window);
+		input_length = scrub->window / N_COMP;
+	} else if (frame_size > 0) {
+		player = calloc(1, sizeof *player);
+		player->frame_size = frame_size;
+		if (is_multi_file) {
+			for (int i = 0; i < inputs.n_files; i++) player_add_file(player, inputs.files[i].path);
+		} else {
+			player_add_file(player, argv[1]);
+		}
+		for (int i = 0; i < n_frame_paths; i++) player_add_file(player, frame_paths[i]);
+		if (player->n_frames == 0) {
+			fprintf(stderr, "%s: no complete frames of %zu bytes\n", argv[1], frame_size);
+			exit(EXIT_FAILURE);
+		}
+		input_length = frame_size / N_COMP;
+	} else {
+		doc = calloc(1, sizeof *doc);
+		assert(doc != NULL);
+		if (!doc_load(doc, argv[1], &inputs, is_multi_file, &doc_opt)) exit(EXIT_FAILURE);
+		docs[n_docs++] = doc;
+		input_length = doc->input_length;
+	}
+
+	struct control control;
+	if (control_path != NULL) control_open(&control, control_path);
 
 	if (SDL_Init(SDL_INIT_VIDEO) != 0) SDL2FATAL();
 
@@ -275,110 +4410,285 @@ int main(int argc, char** argv)
 	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
 	if (renderer == NULL) SDL2FATAL();
 
-	// figure out an image size that fits all the data; basically
-	// 1<<ceil(log2(sqrt(n))) but without floating point math
-	int width_log2 = 0;
-	while ((1 << (2*width_log2)) < input_length) width_log2++;
-	const int width = 1<<width_log2;
-	const int n_pixels = 1<<(2*width_log2);
-
-	uint8_t* image = calloc(n_pixels, N_COMP);
-	size_t* reverse = calloc(n_pixels, sizeof reverse[0]);
-	memset(reverse, -1, n_pixels*sizeof(reverse[0]));
-
-	// draw curve
-	struct lindenmayer_system lsys;
-	switch (curve_type) {
-	case CURVE_TYPE_hilbert: {
-		const char* rules[] = {
-			"+1^-0^0-^1+",
-			"-0^+1^1+^0-",
-		};
-		lindenmayer_system_init(&lsys, ARRAY_LENGTH(rules), rules, width_log2);
-	}	break;
-	default: assert(!"unreachable");
-	}
-	{
-		int px, py;
-		uint8_t* rp = data;
-		int point_index = 0;
-		while (lindenmayer_system_next_coord(&lsys, &px, &py)) {
-			assert(0 <= px && px < width);
-			assert(0 <= py && py < width);
-			const int image_index = (py << width_log2) + px;
-			assert(0 <= image_index && image_index < n_pixels);
-			uint8_t* wp = &image[image_index*N_COMP];
-			for (int c=0; c<N_COMP; c++) *(wp++) = *(rp++);
-			reverse[image_index] = point_index++;
-		}
-	}
+	int width_log2 = uncurl_width_log2_for_length(input_length);
+	int width = 1<<width_log2;
+	const size_t n_pixels = scrub != NULL ? (size_t)1<<(2*width_log2) : 0;
 
-	SDL_Texture* texture;
-	{
+	// draw curve; documents draw their own, frames are curled as they're
+	// read and windows as they move
+	assert((curve_type == UNCURL_CURVE_TYPE_hilbert) && "only the Hilbert curve is rasterized");
+	if (doc != NULL) doc_init_view(doc, renderer);
+
+	SDL_Texture* texture = NULL;
+	struct lod* lod = NULL;
+	uint8_t* scrub_image = NULL;
+	uint8_t* scrub_tiles = NULL;
+	int scrub_tile_log2 = 0;
+	size_t scrub_shown_offset = -1;
+	int overview_percent = -1;
+	if (player != NULL) {
+		player_init(player, renderer, width_log2);
+		player_present_next(player, use_delta, 1);
+	} else if (scrub != NULL) {
+		scrub_image = calloc(n_pixels, N_COMP);
+		assert(scrub_image != NULL);
 		assert((N_COMP == 3) && "hardcoded pixel format needs N_COMP==3");
-		const Uint32 desired_format = SDL_PIXELFORMAT_RGB24;
-		const int desired_access = SDL_TEXTUREACCESS_STATIC;
-		texture = SDL_CreateTexture(renderer, desired_format, desired_access, width, width);
+		texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, width, width);
 		if (texture == NULL) SDL2FATAL();
-		// sanity check (don't know if this is necessary)
-		Uint32 actual_format;
-		int actual_access, actual_width, actual_height;
-		if (SDL_QueryTexture(texture, &actual_format, &actual_access, &actual_width, &actual_height) < 0) SDL2FATAL();
-		assert(actual_format == desired_format);
-		assert(actual_access == desired_access);
-		assert(actual_width == width);
-		assert(actual_height == width); // width==height
+		SDL_UpdateTexture(texture, NULL, scrub_image, N_COMP*width);
+		// only tiles that the window's points land in ever change. a tile
+		// is an aligned block of the curve; its first point says which
+		scrub_tile_log2 = width_log2 < SCRUB_TILE_LOG2 ? width_log2 : SCRUB_TILE_LOG2;
+		const int tiles_log2 = width_log2 - scrub_tile_log2;
+		scrub_tiles = calloc((size_t)1<<(2*tiles_log2), 1);
+		assert(scrub_tiles != NULL);
+		const size_t n_blocks = (input_length + ((size_t)1<<(2*scrub_tile_log2)) - 1) >> (2*scrub_tile_log2);
+		for (size_t b = 0; b < n_blocks; b++) {
+			const uint64_t d = (uint64_t)b << (2*scrub_tile_log2);
+			uint32_t x, y;
+			uncurl_d2xy(width_log2, 1, &d, &x, &y);
+			scrub_tiles[((size_t)(y >> scrub_tile_log2) << tiles_log2) + (x >> scrub_tile_log2)] = 1;
+		}
+	}
+
+	// labels need the bytes behind each pixel. overlays cache per pane
+	struct labels labels[MAX_PANES];
+	for (int i = 0; i < MAX_PANES; i++) labels_init(&labels[i], renderer);
+	int show_labels = 1;
+	struct path_overlay path_overlay[MAX_PANES] = {0};
+	int show_path = 0;
+	struct elf_map* elf = scrub != NULL ? elf_open(argv[1]) : NULL;
+	int show_elf = (elf != NULL);
+	struct pointers* pointers = NULL;
+	if (scrub != NULL && use_pointers) {
+		pointers = pointers_open(argv[1], elf, has_pointer_base, pointer_base);
+		if (pointers == NULL) exit(EXIT_FAILURE);
+	}
+	int show_pointers = 1;
+	struct strings* strings = NULL;
+	if (scrub != NULL && strings_min > 0) strings = strings_open(argv[1], scrub->map, scrub->size, strings_min);
+	int show_strings = 1;
+	struct strings_overlay strings_overlay[MAX_PANES] = {0};
+	int64_t shown_string = -1;
+	struct values* values = NULL;
+	if (scrub != NULL) {
+		values = values_open(argv[1], scrub->map, scrub->size, N_COMP);
+		if (find_text != NULL) values_find(values, &find_query, find_text);
+	}
+	int show_values = 1;
+	struct values_overlay values_overlay[MAX_PANES] = {0};
+	char shown_values[1<<9] = "";
+	int n_offset_digits = 1;
+	size_t point_size = N_COMP; // input bytes per point
+	struct indexed_view* indexed = NULL;
+	if (doc == NULL) {
+		const size_t total = scrub != NULL ? scrub->size : input_length*N_COMP;
+		while (n_offset_digits < 16 && (total-1) >> (4*n_offset_digits)) n_offset_digits++;
+	}
+
+	SDL_Texture* boundary_texture = NULL;
+	int show_boundaries = 0;
+
+	// extract sources for single inputs; other cases are resolved per range
+	int input_fd = -1;
+	const uint8_t* input_mem = scrub != NULL ? scrub->map : data;
+	if (scrub != NULL && n_extract_paths > 0) {
+		input_fd = open(argv[1], O_RDONLY);
 	}
-	SDL_UpdateTexture(texture, NULL, image, N_COMP*width);
+	struct { size_t begin, end; } selection[64];
+	int n_selection = 0;
+	int is_selecting = 0;
+	size_t select_anchor = 0;
+	struct { size_t begin, end; } highlights[256];
+	int n_highlights = 0;
+	struct doc* shown_doc = NULL;
 
+	int is_scrub_dragging = 0;
+	double last_time = get_time();
+	int is_playing = (player != NULL);
+	double next_frame_time = get_time();
+	int shown_frame = -1;
 	int is_exiting = 0;
 	int is_panning = 0;
+	double last_motion_time = 0.0;
+	int full_width, full_height;
 	while (!is_exiting) {
-		SDL_GetWindowSize(window, &window_width, &window_height);
+		SDL_GetWindowSize(window, &full_width, &full_height);
+		panes_layout(full_width, full_height);
+
+		struct doc* loaded;
+		const int is_wanted = loader != NULL && loader->is_wanted;
+		if (loader != NULL && doc_loader_poll(loader, &loaded)) {
+			loader = NULL;
+			if (loaded != NULL) {
+				doc_init_view(loaded, renderer);
+				docs[n_docs++] = loaded;
+				if (is_wanted) {
+					doc = loaded;
+					panes_reset_views();
+				}
+			} else {
+				free(failed_path);
+				failed_path = loader_path;
+				loader_path = NULL;
+			}
+			char title[1<<8];
+			snprintf(title, sizeof title, "uncurl - %s", doc->path);
+			SDL_SetWindowTitle(window, title);
+		}
+
+		if (doc != shown_doc) {
+			shown_doc = doc;
+			data = doc->data;
+			input_mem = doc->data;
+			input_length = doc->input_length;
+			overview = doc->overview;
+			overview_percent = -1;
+			width_log2 = doc->width_log2;
+			width = 1<<width_log2;
+			texture = doc->texture;
+			lod = doc->lod;
+			boundary_texture = doc->boundary_texture;
+			show_boundaries = boundary_texture != NULL;
+			inputs = doc->inputs;
+			is_multi_file = doc->is_multi_file;
+			input_fd = doc->fd;
+			n_offset_digits = doc->n_offset_digits;
+			point_size = doc->point_size;
+			indexed = doc->indexed;
+			elf = doc->elf;
+			show_elf = (elf != NULL);
+			pointers = doc->pointers;
+			strings = doc->strings;
+			shown_string = -1;
+			values = doc->values;
+			shown_values[0] = 0;
+			n_selection = 0;
+			n_highlights = 0;
+			for (int i = 0; i < MAX_PANES; i++) {
+				labels[i].is_valid = 0;
+				path_overlay[i].is_valid = 0;
+				strings_overlay[i].is_valid = 0;
+				values_overlay[i].tint.is_valid = 0;
+			}
+		}
 
 		SDL_Event ev;
 		while (SDL_PollEvent(&ev)) {
+			// mouse events go to the pane they're over (or where the drag
+			// began) in its coordinates; the slider is over all of them
+			int mouse_x = -1;
+			if (ev.type == SDL_MOUSEBUTTONDOWN || ev.type == SDL_MOUSEBUTTONUP) mouse_x = ev.button.x;
+			if (ev.type == SDL_MOUSEMOTION) mouse_x = ev.motion.x;
+			if (ev.type == SDL_MOUSEWHEEL) mouse_x = ev.wheel.mouseX;
+			if (mouse_x >= 0) {
+				if (!is_panning && !is_selecting) pane_select(pane_at(mouse_x));
+				const int ox = panes[current_pane].rect.x;
+				if (ev.type == SDL_MOUSEMOTION) {
+					ev.motion.x -= ox;
+				} else if (ev.type == SDL_MOUSEWHEEL) {
+					ev.wheel.mouseX -= ox;
+				} else {
+					ev.button.x -= ox;
+				}
+			}
 			if (ev.type == SDL_QUIT) {
 				is_exiting = 1;
 			} else if (ev.type == SDL_WINDOWEVENT && ev.window.event == SDL_WINDOWEVENT_CLOSE) {
 				is_exiting = 1;
 			} else if (ev.type == SDL_KEYDOWN) {
-				if (ev.key.keysym.sym == SDLK_ESCAPE) is_exiting = 1;
+				const SDL_Keycode sym = ev.key.keysym.sym;
+				if (sym == SDLK_ESCAPE) is_exiting = 1;
+				if (sym == SDLK_b) show_boundaries = !show_boundaries;
+				if (sym == SDLK_l) show_labels = !show_labels;
+				if (sym == SDLK_p) show_path = !show_path;
+				if (sym == SDLK_e) show_elf = !show_elf;
+				if (sym == SDLK_g) show_pointers = !show_pointers;
+				if (sym == SDLK_t) show_strings = !show_strings;
+				if (sym == SDLK_f) show_values = !show_values;
+				if (sym == SDLK_c) palette = (palette + 1) % N_PALETTES;
+				if (sym == SDLK_s) panes_toggle_split();
+				if (sym == SDLK_z) is_zoom_linked = !is_zoom_linked;
+				if (player != NULL) {
+					const int cur = player->current_frame;
+					const int n = player->n_frames;
+					const int big_step = n >= 100 ? n/10 : 10;
+					int seek_to = -1;
+					if (sym == SDLK_SPACE) {
+						is_playing = !is_playing;
+						next_frame_time = get_time();
+					} else if (sym == SDLK_RIGHT) {
+						is_playing = 0;
+						player_present_next(player, use_delta, 1);
+					} else if (sym == SDLK_LEFT) {
+						seek_to = cur - 1;
+					} else if (sym == SDLK_PAGEUP) {
+						seek_to = cur - big_step;
+					} else if (sym == SDLK_PAGEDOWN) {
+						seek_to = cur + big_step;
+					} else if (sym == SDLK_HOME) {
+						seek_to = 0;
+					} else if (sym == SDLK_END) {
+						seek_to = n-1;
+					}
+					if (seek_to != -1) {
+						if (sym != SDLK_PAGEUP && sym != SDLK_PAGEDOWN) is_playing = 0;
+						player_seek(player, seek_to);
+						player_present_next(player, use_delta, 1);
+						next_frame_time = get_time() + 1.0/fps;
+					}
+				}
 			} else if (ev.type == SDL_MOUSEBUTTONDOWN) {
 				const int b = ev.button.button;
-				if (b == MOUSE_BUTTON_SELECT) {
-					const int mx = ev.button.x;
-					const int my = ev.button.y;
-					double lx,ly;
-					map_screen_to_local(mx, my, &lx, &ly);
-					lx += width/2;
-					ly += width/2;
-					if (0 <= lx && lx <= width && 0 <= ly && ly <= width) {
-						const int ix = lx;
-						const int iy = ly;
-						const int ii = (iy << width_log2) + ix;
-						if (0 <= ii && ii < n_pixels) {
-							const int iii = reverse[ii];
-							if (iii >= 0) {
-								if (copy_to_clipboard_on_click) {
-									char buf[1<<10];
-									snprintf(buf, sizeof buf, "%d", iii);
-									SDL_SetClipboardText(buf);
-								}
-								for (int j = 0; j < n_output_paths; j++) {
-									const char* path = output_paths[j];
-									if (strcmp("-",path) == 0) {
-										printf("%d\n", iii);
-									} else {
-										FILE* out = fopen(path, "w");
-										assert(out != NULL);
-										fprintf(out, "%d\n", iii);
-										fclose(out);
-									}
-								}
-								if (exit_on_click) is_exiting = 1;
+				if (b == MOUSE_BUTTON_SELECT && scrub != NULL && ev.button.y >= window_height - SCRUB_SLIDER_HEIGHT) {
+					is_scrub_dragging = 1;
+					scrub_slider_drag(scrub, mouse_x, full_width);
+				} else if (b == MOUSE_BUTTON_SELECT) {
+					const int64_t iii = screen_to_point(ev.button.x, ev.button.y, width_log2, input_length);
+					if (iii >= 0) {
+						// NOTE in frames mode the coordinate is relative to the frame
+						const size_t coord = (scrub != NULL ? scrub->offset/N_COMP : 0) + iii;
+						char buf[1<<13];
+						if (is_multi_file && player == NULL) {
+							const size_t byte_offset = coord*N_COMP;
+							const struct uncurl_input_file* f = &inputs.files[uncurl_input_set_find(&inputs, byte_offset)];
+							snprintf(buf, sizeof buf, "%zu\t%s\t%zu", coord, f->path, byte_offset - f->offset);
+						} else if (elf != NULL) {
+							char where[1<<12];
+							elf_describe(elf, coord*point_size, where, sizeof where);
+							snprintf(buf, sizeof buf, "%zu\t%s", coord, where);
+						} else {
+							snprintf(buf, sizeof buf, "%zu", coord);
+						}
+						const int64_t si = strings != NULL && strings_update(strings) ? strings_find(strings, coord*point_size) : -1;
+						if (si >= 0) {
+							char text[STRINGS_SHOW_MAX + 8];
+							strings_text(strings, si, text, sizeof text);
+							const size_t n = strlen(buf);
+							snprintf(buf + n, sizeof buf - n, "\t0x%llx\t%s", (unsigned long long)strings->runs[si].offset, text);
+						}
+						if (copy_to_clipboard_on_click) {
+							SDL_SetClipboardText(buf);
+						}
+						for (int j = 0; j < n_output_paths; j++) {
+							const char* path = output_paths[j];
+							if (strcmp("-",path) == 0) {
+								printf("%s\n", buf);
+							} else {
+								FILE* out = fopen(path, "w");
+								assert(out != NULL);
+								fprintf(out, "%s\n", buf);
+								fclose(out);
 							}
 						}
+						if (n_extract_paths > 0) {
+							// the range is completed on release; CTRL adds to the selection
+							if (!(SDL_GetModState() & KMOD_CTRL)) n_selection = 0;
+							is_selecting = 1;
+							select_anchor = coord;
+						} else if (exit_on_click) {
+							is_exiting = 1;
+						}
 					}
 				} else if (b == MOUSE_BUTTON_PAN) {
 					is_panning = 1;
@@ -387,49 +4697,432 @@ int main(int argc, char** argv)
 				const int b = ev.button.button;
 				if (b == MOUSE_BUTTON_PAN) {
 					is_panning = 0;
+				} else if (b == MOUSE_BUTTON_SELECT) {
+					is_scrub_dragging = 0;
+					if (is_selecting) {
+						is_selecting = 0;
+						const int64_t iii = screen_to_point(ev.button.x, ev.button.y, width_log2, input_length);
+						const size_t coord = iii >= 0 ? (scrub != NULL ? scrub->offset/N_COMP : 0) + iii : select_anchor;
+						const int is_added = n_selection < ARRAY_LENGTH(selection);
+						if (is_added) {
+							selection[n_selection].begin = (coord < select_anchor ? coord : select_anchor) * point_size;
+							selection[n_selection].end = ((coord > select_anchor ? coord : select_anchor) + 1) * point_size;
+							n_selection++;
+						}
+						// only the new range; the writers have the earlier ones
+						for (int j = 0; is_added && j < n_extract_paths; j++) {
+							struct extract_job* job = extract_job_new(n_selection == 1);
+							const size_t sb = selection[n_selection-1].begin;
+							const size_t se = selection[n_selection-1].end;
+							if (is_multi_file && player == NULL) {
+								input_set_extract(&inputs, job, sb, se);
+							} else if (player != NULL) {
+								const struct player_frame* f = &player->frames[player->current_frame];
+								extract_job_add_piece(job, f->fd, f->mem, f->offset + sb, se-sb);
+							} else {
+								extract_job_add_piece(job, input_fd, input_mem, sb, se-sb);
+							}
+							extract_output_queue(extract_outputs[j], job);
+						}
+						char title[1<<8];
+						snprintf(title, sizeof title, "uncurl - extracting %d range(s), last 0x%zx-0x%zx", n_selection, selection[n_selection-1].begin, selection[n_selection-1].end);
+						SDL_SetWindowTitle(window, title);
+						if (exit_on_click) is_exiting = 1;
+					}
 				}
 			} else if (ev.type == SDL_MOUSEMOTION) {
+				if (is_scrub_dragging) {
+					scrub_slider_drag(scrub, mouse_x, full_width);
+				}
 				if (is_panning) {
 					pan_x += (double)ev.motion.xrel;
 					pan_y += (double)ev.motion.yrel;
+					last_motion_time = get_time();
 				}
 			} else if (ev.type == SDL_MOUSEWHEEL) {
 				const double mx = ev.wheel.mouseX;
 				const double my = ev.wheel.mouseY;
 				double plx,ply;
 				map_screen_to_local(mx, my, &plx, &ply);
+				const double prev_scale = scale;
 				scale *= pow(MOUSE_WHEEL_SENSITIVITY, ev.wheel.y);
 				double lx,ly;
 				map_screen_to_local(mx, my, &lx, &ly);
 				pan_x += (lx-plx)*scale;
 				pan_y += (ly-ply)*scale;
+				panes_sync_zoom(prev_scale);
+				last_motion_time = get_time();
+			}
+		}
+
+		const char* line;
+		int client;
+		for (int n_commands = 0; control_path != NULL && n_commands < CONTROL_MAX_PER_FRAME && (line = control_next(&control, &client)) != NULL; n_commands++) {
+			// offsets count like click coordinates do
+			const size_t base = scrub != NULL ? scrub->offset : 0;
+			const char* args = NULL;
+			unsigned long long o[2];
+			uint64_t b, e;
+			if (starts_with(line, "open ", &args)) {
+				if (doc == NULL) {
+					control_reply(&control, client, "error open doesn't do frames:<SIZE> or window:<SIZE>");
+					continue;
+				}
+				if (doc_opt.green_path != NULL) {
+					control_reply(&control, client, "error open doesn't do green:<PATH> and blue:<PATH>");
+					continue;
+				}
+				struct doc* d = NULL;
+				for (int i = 0; i < n_docs && d == NULL; i++) {
+					if (strcmp(docs[i]->path, args) == 0) d = docs[i];
+				}
+				const int is_loading_it = loader != NULL && strcmp(loader_path, args) == 0;
+				if (d != NULL) {
+					if (loader != NULL) loader->is_wanted = 0;
+					doc = d;
+					panes_reset_views();
+					char title[1<<8];
+					snprintf(title, sizeof title, "uncurl - %s", d->path);
+					SDL_SetWindowTitle(window, title);
+					control_reply(&control, client, "ok %zu", d->input_length*d->point_size);
+				} else if (is_loading_it) {
+					loader->is_wanted = 1;
+					control_reply(&control, client, "ok loading");
+				} else if (failed_path != NULL && strcmp(failed_path, args) == 0) {
+					free(failed_path);
+					failed_path = NULL;
+					control_reply(&control, client, "error could not open %s", args);
+				} else if (loader != NULL) {
+					control_reply(&control, client, "error busy loading %s", loader_path);
+				} else if (n_docs == DOC_MAX) {
+					control_reply(&control, client, "error too many open inputs");
+				} else {
+					loader = doc_loader_start(args, &doc_opt);
+					if (loader == NULL) {
+						control_reply(&control, client, "error could not open %s", args);
+						continue;
+					}
+					free(loader_path);
+					loader_path = strdup(args);
+					assert(loader_path != NULL);
+					SDL_SetWindowTitle(window, "uncurl - loading");
+					control_reply(&control, client, "ok loading");
+				}
+			} else if (starts_with(line, "goto ", &args)) {
+				if (control_parse_offsets(args, o, 1) != 1) {
+					control_reply(&control, client, "error usage: goto <offset>");
+					continue;
+				}
+				if (scrub != NULL && (o[0] < scrub->offset || o[0] >= scrub->offset + scrub->window)) {
+					scrub_set_offset(scrub, (double)o[0] - (double)(scrub->window/2));
+				}
+				if (!control_range_points(o[0], o[0]+1, scrub != NULL ? scrub->offset : 0, point_size, input_length, &b, &e)) {
+					control_reply(&control, client, "error offset past the end");
+					continue;
+				}
+				uint32_t x, y;
+				uncurl_d2xy(width_log2, 1, &b, &x, &y);
+				pan_x = -((double)x + 0.5 - (double)width*0.5) * scale;
+				pan_y = -((double)y + 0.5 - (double)width*0.5) * scale;
+				control_reply(&control, client, "ok %u %u", x, y);
+			} else if (starts_with(line, "zoom ", &args)) {
+				if (control_parse_offsets(args, o, 2) != 2 || o[0] >= o[1]) {
+					control_reply(&control, client, "error usage: zoom <begin> <end>");
+					continue;
+				}
+				if (!control_range_points(o[0], o[1], base, point_size, input_length, &b, &e)) {
+					control_reply(&control, client, "error range not on the image");
+					continue;
+				}
+				struct curve_square sq[CURVE_MAX_SQUARES];
+				const int n = curve_range_squares(width_log2, b, e, sq);
+				int x0 = width, y0 = width, x1 = 0, y1 = 0;
+				for (int i = 0; i < n; i++) {
+					if (sq[i].x < x0) x0 = sq[i].x;
+					if (sq[i].y < y0) y0 = sq[i].y;
+					if (sq[i].x + sq[i].size > x1) x1 = sq[i].x + sq[i].size;
+					if (sq[i].y + sq[i].size > y1) y1 = sq[i].y + sq[i].size;
+				}
+				const int side = (x1-x0) > (y1-y0) ? (x1-x0) : (y1-y0);
+				const double prev_scale = scale;
+				scale = (double)(window_width < window_height ? window_width : window_height) / (double)side;
+				pan_x = -((double)(x0+x1)*0.5 - (double)width*0.5) * scale;
+				pan_y = -((double)(y0+y1)*0.5 - (double)width*0.5) * scale;
+				panes_sync_zoom(prev_scale);
+				control_reply(&control, client, "ok %d %d %d %d", x0, y0, x1, y1);
+			} else if (strcmp(line, "highlight clear") == 0) {
+				n_highlights = 0;
+				control_reply(&control, client, "ok");
+			} else if (starts_with(line, "highlight ", &args)) {
+				if (control_parse_offsets(args, o, 2) != 2 || o[0] >= o[1]) {
+					control_reply(&control, client, "error usage: highlight <begin> <end> | highlight clear");
+					continue;
+				}
+				if (n_highlights == ARRAY_LENGTH(highlights)) {
+					control_reply(&control, client, "error too many highlights");
+					continue;
+				}
+				highlights[n_highlights].begin = o[0];
+				highlights[n_highlights].end = o[1];
+				n_highlights++;
+				control_reply(&control, client, "ok %d", n_highlights);
+			} else if (starts_with(line, "find", &args) && (*args == 0 || *args == ' ')) {
+				if (values == NULL) {
+					control_reply(&control, client, "error find doesn't do frames:<SIZE>");
+					continue;
+				}
+				if (*args == 0) {
+					if (values->text == NULL) {
+						control_reply(&control, client, "error no query");
+					} else if (!values_update(values)) {
+						control_reply(&control, client, "ok scanning");
+					} else {
+						char in_view[1<<8];
+						int n = 0;
+						for (int i = 0; i < n_panes && n < (int)sizeof in_view; i++) {
+							n += snprintf(in_view + n, sizeof in_view - n, "%s%llu", i > 0 ? "," : "", (unsigned long long)values_overlay[i].in_view);
+						}
+						control_reply(&control, client, "ok hits=%llu in_view=%s", (unsigned long long)values->before[values->n_blocks], in_view);
+					}
+					continue;
+				}
+				args++;
+				if (strcmp(args, "clear") == 0) {
+					values_find(values, NULL, NULL);
+					shown_values[0] = 0;
+					SDL_SetWindowTitle(window, "uncurl");
+					control_reply(&control, client, "ok");
+					continue;
+				}
+				struct uncurl_value_query q;
+				if (!values_parse(args, &q)) {
+					control_reply(&control, client, "error usage: find [<TYPE>[@<ALIGN>]:<LO>[:<HI>] | clear]");
+					continue;
+				}
+				values_find(values, &q, args);
+				control_reply(&control, client, "ok");
+			} else if (strcmp(line, "query") == 0) {
+				const int64_t p = screen_to_point(window_width/2, window_height/2, width_log2, input_length);
+				const size_t size = scrub != NULL ? scrub->size : input_length*point_size;
+				control_reply(&control, client, "ok center=%lld scale=%g size=%zu path=%s", p >= 0 ? (long long)(base + p*point_size) : -1LL, scale, size, doc != NULL ? doc->path : argv[1]);
+			} else if (starts_with(line, "query ", &args)) {
+				if (control_parse_offsets(args, o, 1) != 1) {
+					control_reply(&control, client, "error usage: query [<offset>]");
+					continue;
+				}
+				if (!control_range_points(o[0], o[0]+1, base, point_size, input_length, &b, &e)) {
+					control_reply(&control, client, "error offset not on the image");
+					continue;
+				}
+				uint32_t x, y;
+				uncurl_d2xy(width_log2, 1, &b, &x, &y);
+				control_reply(&control, client, "ok %u %u", x, y);
+			} else {
+				control_reply(&control, client, "error unknown command: %s", line);
 			}
 		}
 
 		// There are moiré pattern problems both when zooming in and
 		// out. SDL_ScaleModeLinear offers a slight improvement when
 		// zooming out but mipmapping is required to solve the problem
-		// properly (however, SDL2 has no mipmap support). A "pixel art
+		// properly (however, SDL2 has no mipmap support; the static view
+		// gets by with its own LOD levels, see struct lod). A "pixel art
 		// shader" is required to solve the problem with zooming in; it
 		// anti-aliases the edges between texels without blurring the
 		// image. I suppose that none of these problems are worth the
 		// loss of portability and added complexity.
-		SDL_SetTextureScaleMode(texture, scale > 1.0 ? SDL_ScaleModeNearest : SDL_ScaleModeLinear);
+		const double now = get_time();
+		const double dt = now - last_time;
+		last_time = now;
+
+		if (scrub != NULL) {
+			const Uint8* keys = SDL_GetKeyboardState(NULL);
+			const int dir = (keys[SDL_SCANCODE_RIGHT] ? 1 : 0) - (keys[SDL_SCANCODE_LEFT] ? 1 : 0);
+			if (dir != 0) {
+				// a quarter window per second, accelerating while held
+				const double base = (double)scrub->window * 0.25 * ((SDL_GetModState() & KMOD_SHIFT) ? 8.0 : 1.0);
+				if (scrub->velocity == 0.0 || (scrub->velocity > 0.0) != (dir > 0)) {
+					scrub->velocity = dir * base;
+				} else {
+					scrub->velocity *= pow(2.0, dt);
+				}
+				scrub_set_offset(scrub, (double)scrub->offset + scrub->velocity*dt);
+			} else {
+				// dragged (or moved by a control command); the direction is
+				// where it went since the last frame
+				scrub->velocity = dt > 0.0 ? ((double)scrub->offset - (double)scrub->last_offset) / dt : 0.0;
+			}
+			scrub->last_offset = scrub->offset;
+			scrub_readahead(scrub, dt > 0.0 ? dt : 1.0/30.0);
+			if (scrub->offset != scrub_shown_offset) {
+				scrub_shown_offset = scrub->offset;
+				uncurl_rasterize(scrub->map + scrub->offset, input_length, width_log2, scrub_image, (size_t)N_COMP*width);
+				upload_tiles(texture, scrub_image, width_log2, scrub_tile_log2, scrub_tiles, NULL);
+				char title[1<<8];
+				snprintf(title, sizeof title, "uncurl - 0x%zx-0x%zx of 0x%zx", scrub->offset, scrub->offset + scrub->window, scrub->size);
+				SDL_SetWindowTitle(window, title);
+			}
+		}
+
+		if (overview != NULL && overview_percent < 100) {
+			const int percent = overview_update(overview, texture);
+			if (percent != overview_percent) {
+				overview_percent = percent;
+				char title[1<<8];
+				if (percent < 100) {
+					snprintf(title, sizeof title, "uncurl - loading %d%%", percent);
+				} else {
+					snprintf(title, sizeof title, "uncurl");
+				}
+				SDL_SetWindowTitle(window, title);
+			}
+		}
+
+		if (player != NULL) {
+			if (is_playing) {
+				if (now >= next_frame_time && player_present_next(player, use_delta, 0)) {
+					next_frame_time += 1.0/fps;
+					// don't try to catch up after stalls
+					if (next_frame_time < now) next_frame_time = now;
+				}
+			}
+			texture = player->textures[player->display];
+			if (player->current_frame != shown_frame) {
+				shown_frame = player->current_frame;
+				char title[1<<8];
+				snprintf(title, sizeof title, "uncurl - frame %d/%d", shown_frame, player->n_frames);
+				SDL_SetWindowTitle(window, title);
+			}
+		}
 
+		SDL_RenderSetViewport(renderer, NULL);
 		SDL_RenderClear(renderer);
-		SDL_Rect dst;
-		{
-			const int ex = (double)width*0.5*scale;
-			const int mid_x = (window_width >> 1) + pan_x;
-			const int mid_y = (window_height >> 1) + pan_y;
-			dst.x = mid_x-ex;
-			dst.y = mid_y-ex;
-			dst.w = dst.h = ex*2;
-		}
-		SDL_RenderCopy(renderer, texture, NULL, &dst);
+		const int event_pane = current_pane;
+		// the byte range under the cursor, for the pointers and strings
+		struct byte_range hover = { 0, 0 };
+		if (pointers != NULL || strings != NULL) {
+			int mx, my;
+			SDL_GetMouseState(&mx, &my);
+			pane_select(pane_at(mx));
+			const int64_t iii = screen_to_point(mx - panes[current_pane].rect.x, my, width_log2, input_length);
+			pane_select(event_pane);
+			const size_t base = scrub != NULL ? scrub->offset : 0;
+			if (iii >= 0) hover = (struct byte_range){ base + iii*point_size, base + (iii+1)*point_size };
+		}
+		// the byte ranges to draw pointers out of; the same in every pane
+		struct byte_range pointer_qs[1 + ARRAY_LENGTH(selection)];
+		int n_pointer_qs = 0;
+		if (pointers != NULL && show_pointers) {
+			if (hover.end > hover.begin) pointer_qs[n_pointer_qs++] = hover;
+			for (int k = 0; k < n_selection; k++) pointer_qs[n_pointer_qs++] = (struct byte_range){ selection[k].begin, selection[k].end };
+		}
+		const int show_strings_now = strings != NULL && strings_update(strings);
+		if (show_strings_now) {
+			const int64_t si = hover.end > hover.begin ? strings_find(strings, hover.begin) : -1;
+			if (si != shown_string) {
+				shown_string = si;
+				char title[STRINGS_SHOW_MAX + 64] = "uncurl";
+				if (si >= 0) {
+					char text[STRINGS_SHOW_MAX + 8];
+					strings_text(strings, si, text, sizeof text);
+					snprintf(title, sizeof title, "uncurl - 0x%llx: %s", (unsigned long long)strings->runs[si].offset, text);
+				}
+				SDL_SetWindowTitle(window, title);
+			}
+		}
+		// updated even without a query, to free cancelled scans
+		const int has_query = values != NULL && values->text != NULL;
+		const int show_values_now = values != NULL && values_update(values) && has_query && show_values;
+		for (int i = 0; i < n_panes; i++) {
+			pane_select(i);
+			SDL_RenderSetViewport(renderer, &panes[i].rect);
+			const SDL_Rect clip = { 0, 0, panes[i].rect.w, panes[i].rect.h };
+			SDL_RenderSetClipRect(renderer, &clip);
+			SDL_Texture* draw_texture = texture;
+			int draw_level = 0;
+			if (lod != NULL) {
+				int level = 0;
+				while (level < width_log2 && (double)(2 << level) * scale <= 1.0) level++;
+				if (now - last_motion_time < LOD_IDLE_TIME) level += LOD_MOTION_BIAS;
+				SDL_Texture* t = lod_texture(lod, renderer, level, &draw_level);
+				if (t != NULL) draw_texture = t;
+			}
+			if (draw_texture != NULL) SDL_SetTextureScaleMode(draw_texture, (draw_level == 0 && scale > 1.0) ? SDL_ScaleModeNearest : SDL_ScaleModeLinear);
+
+			SDL_Rect dst;
+			{
+				const int ex = (double)width*0.5*scale;
+				const int mid_x = (window_width >> 1) + pan_x;
+				const int mid_y = (window_height >> 1) + pan_y;
+				dst.x = mid_x-ex;
+				dst.y = mid_y-ex;
+				dst.w = dst.h = ex*2;
+			}
+			if (indexed != NULL) {
+				indexed_view_draw(indexed, renderer, i, dst, palette);
+			} else {
+				SDL_RenderCopy(renderer, draw_texture, NULL, &dst);
+			}
+			if (show_boundaries) {
+				SDL_SetTextureScaleMode(boundary_texture, SDL_ScaleModeNearest);
+				SDL_RenderCopy(renderer, boundary_texture, NULL, &dst);
+			}
+			if (show_elf && elf != NULL) elf_draw(elf, renderer, dst, width_log2, scrub != NULL ? scrub->offset : 0, point_size, input_length);
+			if (show_path) path_overlay_draw(&path_overlay[i], renderer, dst, width_log2, input_length);
+			if (show_strings_now && show_strings) strings_overlay_draw(&strings_overlay[i], strings, renderer, dst, width_log2, scrub != NULL ? scrub->offset : 0, point_size, input_length);
+			if (show_values_now) values_overlay_draw(&values_overlay[i], values, renderer, dst, width_log2, scrub != NULL ? scrub->offset : 0, point_size, input_length);
+			if (n_pointer_qs > 0) pointers_draw(pointers, renderer, dst, width_log2, scrub != NULL ? scrub->offset : 0, point_size, input_length, pointer_qs, n_pointer_qs);
+			if (n_highlights > 0) {
+				SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+				SDL_SetRenderDrawColor(renderer, 255, 255, 0, 96);
+				for (int h = 0; h < n_highlights; h++) {
+					uint64_t b, e;
+					if (!control_range_points(highlights[h].begin, highlights[h].end, scrub != NULL ? scrub->offset : 0, point_size, input_length, &b, &e)) continue;
+					curve_range_fill(renderer, dst, width_log2, b, e);
+				}
+				SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+			}
+			// not for frames or the overview; their pixels aren't at hand
+			if (show_labels && scrub != NULL) {
+				labels_draw(&labels[i], renderer, dst, width_log2, input_length, scrub->map + scrub->offset, scrub->offset, n_offset_digits, scrub->offset);
+			} else if (show_labels && data != NULL && point_size == N_COMP) {
+				labels_draw(&labels[i], renderer, dst, width_log2, input_length, data, 0, n_offset_digits, 0);
+			}
+			// some backends apply scale modes at once; keep the next pane's
+			// from reaching this one's batched draws
+			if (n_panes > 1) SDL_RenderFlush(renderer);
+		}
+		pane_select(event_pane);
+		if (has_query && show_values) {
+			char title[sizeof shown_values];
+			int n = snprintf(title, sizeof title, "uncurl - find %s: ", values->text);
+			if (show_values_now) {
+				for (int i = 0; i < n_panes && n < (int)sizeof title; i++) {
+					n += snprintf(title + n, sizeof title - n, "%s%llu", i > 0 ? " | " : "", (unsigned long long)values_overlay[i].in_view);
+				}
+				if (n < (int)sizeof title) snprintf(title + n, sizeof title - n, " in view, %llu in all", (unsigned long long)values->before[values->n_blocks]);
+			} else if (n < (int)sizeof title) {
+				snprintf(title + n, sizeof title - n, "%s", values->scan != NULL ? "scanning" : "could not read the input");
+			}
+			if (strcmp(title, shown_values) != 0) {
+				strcpy(shown_values, title);
+				SDL_SetWindowTitle(window, title);
+			}
+		}
+		SDL_RenderSetClipRect(renderer, NULL);
+		SDL_RenderSetViewport(renderer, NULL);
+		if (n_panes > 1) {
+			SDL_SetRenderDrawColor(renderer, 80, 80, 80, 255);
+			for (int i = 1; i < n_panes; i++) SDL_RenderDrawLine(renderer, panes[i].rect.x, 0, panes[i].rect.x, full_height);
+			SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+		}
+		if (scrub != NULL) scrub_draw_slider(scrub, renderer, full_width, full_height);
 		SDL_RenderPresent(renderer);
 	}
 
+	for (int i = 0; i < n_extract_paths; i++) extract_output_close(extract_outputs[i]);
+	if (control_path != NULL) unlink(control_path);
+
 	return EXIT_SUCCESS;
 }
 /*
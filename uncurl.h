@@ -0,0 +1,279 @@
+// libuncurl - public domain
+//
+// The parts of uncurl that don't need SDL: ingest, the curve kernels, and
+// rasterization of 1D RGB streams along the curve. Link with libuncurl.a (or
+// -luncurl) and -lpthread -lm.
+//
+// All functions are thread-safe; none of them keep state between calls
+// (save for lookup tables and the thread pool, which are set up on first
+// use). Buffers are always supplied by the caller and used in place;
+// nothing is copied. Functions that do heavy lifting spread it over the
+// cores by themselves (save for uncurl_permutation_new(), which is meant to
+// be called once). Bad arguments and running out of memory are reported by
+// returning NULL or -1, as each function says; the library never exits.
+
+#ifndef UNCURL_H
+#define UNCURL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UNCURL_N_COMP (3) // bytes per point; input is an RGB stream
+
+#define UNCURL_EMIT_CURVE_TYPES \
+	X(hilbert)
+
+enum uncurl_curve_type {
+	#define X(NAME) UNCURL_CURVE_TYPE_ ## NAME,
+	UNCURL_EMIT_CURVE_TYPES
+	#undef X
+};
+
+// ingest
+
+// reads a file ("-" is stdin) into a malloc()'d buffer. returns NULL if it
+// can't be opened, read or allocated
+uint8_t* uncurl_read_entire_file(const char* path, size_t* out_size);
+
+// parses byte sizes like "4096", "64k", "64M" or "1G"
+int uncurl_parse_size(const char* s, size_t* out_size);
+
+// multi-file input: a directory (walked recursively), a glob pattern or
+// "@<PATH>" naming a file with one path per line. files are concatenated
+// along the curve, each padded to a whole number of points.
+struct uncurl_input_file {
+	char* path;
+	size_t offset; // in bytes, into the concatenated data
+	size_t size;
+	int fd; // for the caller's use; -1 after expansion
+};
+
+struct uncurl_input_set {
+	int n_files, cap;
+	struct uncurl_input_file* files;
+	size_t total_size;
+	char error[1<<12]; // what failed, e.g. "foo: could not stat"
+};
+
+// returns 1 if arg named several files, 0 if it's just a plain input path
+// (or "-") and -1 on errors (see set->error)
+int uncurl_input_set_expand(struct uncurl_input_set* set, const char* arg);
+// reads all files into one malloc()'d buffer of set->total_size bytes.
+// returns NULL if it can't be allocated or any file comes up short (see
+// set->error)
+uint8_t* uncurl_input_set_read(struct uncurl_input_set* set);
+// binary search for the file containing a byte offset into the concatenation
+int uncurl_input_set_find(const struct uncurl_input_set* set, size_t offset);
+
+// curve
+
+// smallest width_log2 so that (1<<width_log2)^2 points fit n_points
+int uncurl_width_log2_for_length(size_t n_points);
+
+// bulk conversion between 1D coordinates and x/y. d must be below
+// 1<<(2*width_log2), and x,y below 1<<width_log2; higher bits are ignored
+void uncurl_d2xy(int width_log2, size_t n, const uint64_t* d, uint32_t* out_x, uint32_t* out_y);
+void uncurl_xy2d(int width_log2, size_t n, const uint32_t* x, const uint32_t* y, uint64_t* out_d);
+
+// returns the curve as a malloc()'d permutation; reverse[image_index] is the
+// 1D coordinate drawn at that pixel, or -1 if it's past n_points. worth it
+// when the same curve is filled many times (see uncurl_fill()). returns NULL
+// for unknown curves, width_log2 outside [0;15] (the indices are int32) or
+// if memory runs out
+int32_t* uncurl_permutation_new(enum uncurl_curve_type curve_type, int width_log2, size_t n_points);
+
+// fills image (tightly packed RGB, n_pixels of them) from data by gathering
+// along a permutation
+void uncurl_fill(uint8_t* image, const int32_t* reverse, int n_pixels, const uint8_t* data);
+
+// draws n_points of data along the curve into image, a (1<<width_log2)^2
+// RGB image with rows stride bytes apart. pixels past the data are cleared
+void uncurl_rasterize(const uint8_t* data, size_t n_points, int width_log2, uint8_t* image, size_t stride);
+
+// like uncurl_rasterize(), but for indexed images: data and image have one
+// byte per point and pixel (palette indices, say). pixels past the data are 0
+void uncurl_rasterize_index(const uint8_t* data, size_t n_points, int width_log2, uint8_t* image, size_t stride);
+
+// like uncurl_rasterize(), but only draws rows [y0;y0+n_rows) into image,
+// which starts at row y0; for large images that are uploaded or written out
+// a band at a time and never need to be whole. y0 and n_rows are multiples
+// of UNCURL_BAND_ROWS, unless the image is narrower than that (then the band
+// is the whole image)
+#define UNCURL_BAND_ROWS (64)
+void uncurl_rasterize_rows(const uint8_t* data, size_t n_points, int width_log2, uint32_t y0, uint32_t n_rows, uint8_t* image, size_t stride);
+
+// the inverse of uncurl_rasterize(): reads points [d0;d0+n_points) out of
+// image, which has bytes_per_pixel >= 3 (the first 3 are used), into out
+void uncurl_flatten(const uint8_t* image, int width_log2, size_t stride, int bytes_per_pixel, uint64_t d0, size_t n_points, uint8_t* out);
+
+// box-filters data for a view 2^level times smaller: out[i] is the average
+// of points [i*4^level;(i+1)*4^level), which curl to an aligned 2^level
+// square. out needs room for ceil(n_points/4^level) points
+void uncurl_reduce(const uint8_t* data, size_t n_points, int level, uint8_t* out);
+
+// interleaves N_COMP single-channel streams into points, e.g. to compare
+// three inputs as the channels of one view. channel c has sizes[c] bytes;
+// points past the end of a channel get 0 for it. out has room for
+// n_points points
+void uncurl_interleave(const uint8_t* const* channels, const size_t* sizes, size_t n_points, uint8_t* out);
+
+// colour projection
+
+// wide records (feature vectors, packed structs) are drawn by projecting
+// each onto 3 directions, one per channel: channel = weights.record + bias,
+// with every byte of the record a feature
+#define UNCURL_RECORD_MAX (1<<12)
+
+enum uncurl_projection_type {
+	UNCURL_PROJECTION_PCA, // the principal components of a sample
+	UNCURL_PROJECTION_RANDOM, // fixed random directions; no fitting passes
+};
+
+struct uncurl_projection {
+	int record_size;
+	float weights[UNCURL_N_COMP][UNCURL_RECORD_MAX];
+	float bias[UNCURL_N_COMP];
+};
+
+// fits a projection of records of record_size bytes (at most
+// UNCURL_RECORD_MAX) on an evenly spread sample of data, scaled so that
+// +-2 standard deviations around the mean fill each channel
+void uncurl_projection_fit(struct uncurl_projection* proj, enum uncurl_projection_type type, const uint8_t* data, size_t n_records, int record_size);
+
+// projects n_records records of data into out, UNCURL_N_COMP bytes (one
+// point) each
+void uncurl_project(const struct uncurl_projection* proj, const uint8_t* data, size_t n_records, uint8_t* out);
+
+// compressibility
+
+// entropy misses repetition at long range; compressing blocks doesn't
+#define UNCURL_COMPRESS_BLOCK_MAX (1<<16)
+
+// estimates how well each block_size bytes of data compress with a fast
+// LZ77 (LZ4's greedy parse, counted rather than written out). out[i] is
+// 1 + 254*compressed/original size for block i, at most 255; incompressible
+// blocks are 255. out needs room for ceil(size/block_size) blocks. returns
+// -1 if block_size isn't in [1;UNCURL_COMPRESS_BLOCK_MAX], 0 otherwise
+int uncurl_compressibility(const uint8_t* data, size_t size, size_t block_size, uint8_t* out);
+
+// pointer scan
+
+// memory dumps are largely pointers. an address range is a piece of the
+// dumped address space and where it is in the dump
+struct uncurl_address_range {
+	uint64_t vaddr, size;
+	uint64_t offset; // of vaddr, in the dump
+};
+
+struct uncurl_edge {
+	uint64_t source, target; // byte offsets into the dump
+};
+
+// edges sorted by source, compressed; lookups are a binary search and a
+// short decode
+struct uncurl_pointer_graph;
+
+// scans every aligned 8-byte word of data (in big-endian byte order if
+// is_be) for values that are addresses in one of the ranges, and returns
+// the edges from each such word to the offset of what it points at
+struct uncurl_pointer_graph* uncurl_pointer_graph_new(const uint8_t* data, size_t size, const struct uncurl_address_range* ranges, int n_ranges, int is_be);
+void uncurl_pointer_graph_free(struct uncurl_pointer_graph* graph);
+size_t uncurl_pointer_graph_n_edges(const struct uncurl_pointer_graph* graph);
+// writes (up to max of) the edges with sources in [begin;end) into out, in
+// order; returns the number written
+size_t uncurl_pointer_graph_find(const struct uncurl_pointer_graph* graph, uint64_t begin, uint64_t end, struct uncurl_edge* out, size_t max);
+
+// printable strings
+
+struct uncurl_string {
+	uint64_t offset, length;
+};
+
+// finds the runs of at least min_length printable ASCII characters (tabs
+// included) in data, like strings(1) does. returns them as a malloc()'d
+// array sorted by offset, and their number in out_n. returns NULL if
+// min_length is 0 or memory runs out
+struct uncurl_string* uncurl_strings_find(const uint8_t* data, size_t size, size_t min_length, size_t* out_n);
+
+// typed value queries
+
+enum uncurl_value_type {
+	UNCURL_VALUE_UNSIGNED,
+	UNCURL_VALUE_SIGNED,
+	UNCURL_VALUE_FLOAT, // IEEE 754 binary32 or binary64
+};
+
+// matches the values of a type in [lo;hi], or the NaNs if is_nan, at offsets
+// that are multiples of alignment (counted from the start of the data)
+struct uncurl_value_query {
+	enum uncurl_value_type type;
+	int width; // bytes: 1, 2, 4 or 8; 4 or 8 for floats
+	int is_be;
+	size_t alignment; // a power of two
+	int is_nan;
+	union {
+		uint64_t u;
+		int64_t i;
+		double f;
+	} lo, hi; // inclusive; the member for the type
+};
+
+// counts the values matching query that fit in data. if counts isn't NULL,
+// counts[i] is the number starting in bytes [i*block_size;(i+1)*block_size);
+// it needs room for ceil(size/block_size) blocks. returns the total, or -1
+// if the query isn't valid (see above), block_size is 0 or memory runs out
+int64_t uncurl_values_count(const uint8_t* data, size_t size, const struct uncurl_value_query* query, size_t block_size, uint32_t* counts);
+
+// a view like the viewer's: the image is centered in the output, then moved
+// by pan and magnified by scale
+struct uncurl_view {
+	double pan_x, pan_y;
+	double scale;
+};
+
+// renders data as uncurl_rasterize() would draw it, seen through view,
+// straight into an RGB buffer of out_width x out_height (rows out_stride
+// bytes apart) without an intermediate image. nearest neighbour sampling;
+// the background is black
+void uncurl_render_view(const uint8_t* data, size_t n_points, int width_log2, const struct uncurl_view* view, uint8_t* out, int out_width, int out_height, size_t out_stride);
+
+// threads
+
+// cores available to the process
+int uncurl_n_cpus(void);
+
+// all parallel work, the library's own included, runs on one shared pool of
+// work-stealing workers. jobs should be small (a block of curve points, a
+// tile) so that visible work never waits long behind background work
+enum uncurl_priority {
+	UNCURL_PRIORITY_BACKGROUND, // precomputation, prefetching
+	UNCURL_PRIORITY_VISIBLE, // what's on screen, and what's being waited for
+	UNCURL_N_PRIORITIES
+};
+
+struct uncurl_batch;
+
+// queues fn(usr, job) for job in [0;n_jobs) and returns at once
+struct uncurl_batch* uncurl_submit(int n_jobs, void (*fn)(void* usr, int job), void* usr, enum uncurl_priority priority);
+// jobs that haven't started yet are skipped
+void uncurl_batch_cancel(struct uncurl_batch* batch);
+int uncurl_batch_is_done(struct uncurl_batch* batch);
+// returns when every job has run or been skipped; runs jobs of the batch
+// meanwhile
+void uncurl_batch_wait(struct uncurl_batch* batch);
+// gives up the handle; queued jobs still run unless cancelled
+void uncurl_batch_release(struct uncurl_batch* batch);
+
+// submits, waits and releases. the priority is that of the job calling it,
+// if any, so nested work doesn't jump the queue; visible otherwise
+void uncurl_parallel_for(int n_jobs, void (*fn)(void* usr, int job), void* usr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
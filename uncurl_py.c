@@ -0,0 +1,293 @@
+// uncurl Python extension - public domain; see uncurl.h
+//
+// Thin bindings over libuncurl. Inputs are taken through the buffer protocol
+// (bytes, bytearray, memoryview, numpy arrays, mmap, ...) and are only
+// copied when misaligned for the coordinate kernels; results are
+// memoryviews over freshly allocated bytearrays, so
+// numpy.asarray() on them doesn't copy either. The GIL is released while the
+// kernels run.
+//
+//   import uncurl, numpy
+//   img = numpy.asarray(uncurl.curl(data))   # (width, width, 3) uint8
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "uncurl.h"
+
+#define N_COMP (UNCURL_N_COMP)
+
+// wraps a bytearray in a memoryview of the given shape
+static PyObject* shaped_view(PyObject* bytes, const char* format, int ndim, const Py_ssize_t* shape)
+{
+	PyObject* flat = PyMemoryView_FromObject(bytes);
+	Py_DECREF(bytes);
+	if (flat == NULL) return NULL;
+	PyObject* shape_tuple = PyTuple_New(ndim);
+	if (shape_tuple == NULL) {
+		Py_DECREF(flat);
+		return NULL;
+	}
+	for (int i = 0; i < ndim; i++) PyTuple_SET_ITEM(shape_tuple, i, PyLong_FromSsize_t(shape[i]));
+	PyObject* view = PyObject_CallMethod(flat, "cast", "sO", format, shape_tuple);
+	Py_DECREF(shape_tuple);
+	Py_DECREF(flat);
+	return view;
+}
+
+static PyObject* new_bytes(Py_ssize_t size, uint8_t** out_data)
+{
+	PyObject* bytes = PyByteArray_FromStringAndSize(NULL, size);
+	if (bytes != NULL) *out_data = (uint8_t*)PyByteArray_AS_STRING(bytes);
+	return bytes;
+}
+
+static int width_log2_arg(int width_log2, size_t n_points)
+{
+	if (width_log2 < 0) {
+		width_log2 = uncurl_width_log2_for_length(n_points);
+		if (width_log2 > 15) {
+			PyErr_SetString(PyExc_ValueError, "data doesn't fit the largest image (width_log2 15)");
+			return -1;
+		}
+		return width_log2;
+	}
+	if (width_log2 > 15) {
+		PyErr_SetString(PyExc_ValueError, "width_log2 must be at most 15");
+		return -1;
+	}
+	if (n_points > ((size_t)1 << (2*width_log2))) {
+		PyErr_SetString(PyExc_ValueError, "data doesn't fit the image");
+		return -1;
+	}
+	return width_log2;
+}
+
+// the kernels want naturally aligned integers, which a buffer (say a
+// memoryview slice) needn't be; misaligned ones are copied to *tmp, which
+// the caller frees with PyMem_RawFree()
+static const void* aligned_buf(const Py_buffer* b, size_t alignment, void** tmp)
+{
+	*tmp = NULL;
+	if (((uintptr_t)b->buf % alignment) == 0) return b->buf;
+	*tmp = PyMem_RawMalloc(b->len + 1);
+	if (*tmp == NULL) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+	memcpy(*tmp, b->buf, b->len);
+	return *tmp;
+}
+
+PyDoc_STRVAR(curl_doc,
+"curl(data, width_log2=-1, out=None)\n"
+"\n"
+"Draws data, an RGB stream (3 bytes per point), along the curve. Returns a\n"
+"(width, width, 3) memoryview, or out if given; out must be a writable buffer\n"
+"of width*width*3 bytes. width_log2 defaults to the smallest that fits.");
+
+static PyObject* py_curl(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+	static char* kwlist[] = {"data", "width_log2", "out", NULL};
+	Py_buffer data;
+	int width_log2 = -1;
+	PyObject* out_obj = Py_None;
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|iO", kwlist, &data, &width_log2, &out_obj)) return NULL;
+	PyObject* result = NULL;
+	Py_buffer out = {0};
+	if ((data.len % N_COMP) != 0) {
+		PyErr_Format(PyExc_ValueError, "number of bytes must be a multiple of %d", N_COMP);
+		goto done;
+	}
+	const size_t n_points = data.len / N_COMP;
+	width_log2 = width_log2_arg(width_log2, n_points);
+	if (width_log2 < 0) goto done;
+	const Py_ssize_t width = (Py_ssize_t)1 << width_log2;
+	const Py_ssize_t image_size = width*width*N_COMP;
+	uint8_t* image;
+	if (out_obj != Py_None) {
+		if (PyObject_GetBuffer(out_obj, &out, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) == -1) goto done;
+		if (out.len != image_size) {
+			PyErr_Format(PyExc_ValueError, "out must be %zd bytes", image_size);
+			goto done;
+		}
+		image = out.buf;
+		Py_INCREF(out_obj);
+		result = out_obj;
+	} else {
+		PyObject* bytes = new_bytes(image_size, &image);
+		if (bytes == NULL) goto done;
+		const Py_ssize_t shape[] = {width, width, N_COMP};
+		result = shaped_view(bytes, "B", 3, shape);
+		if (result == NULL) goto done;
+	}
+	Py_BEGIN_ALLOW_THREADS
+	uncurl_rasterize(data.buf, n_points, width_log2, image, width*N_COMP);
+	Py_END_ALLOW_THREADS
+done:
+	if (out.obj != NULL) PyBuffer_Release(&out);
+	PyBuffer_Release(&data);
+	return result;
+}
+
+PyDoc_STRVAR(flatten_doc,
+"flatten(image, width_log2, d0=0, n_points=-1)\n"
+"\n"
+"The inverse of curl(): reads points [d0;d0+n_points) back out of a\n"
+"(width, width, 3 or 4) image and returns them as a flat RGB memoryview.");
+
+static PyObject* py_flatten(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+	static char* kwlist[] = {"image", "width_log2", "d0", "n_points", NULL};
+	Py_buffer image;
+	int width_log2;
+	unsigned long long d0 = 0;
+	Py_ssize_t n_points = -1;
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*i|Kn", kwlist, &image, &width_log2, &d0, &n_points)) return NULL;
+	PyObject* result = NULL;
+	if (width_log2 < 0 || width_log2 > 15) {
+		PyErr_SetString(PyExc_ValueError, "width_log2 must be in [0;15]");
+		goto done;
+	}
+	const Py_ssize_t width = (Py_ssize_t)1 << width_log2;
+	const Py_ssize_t n_pixels = width*width;
+	const int bytes_per_pixel = image.len / n_pixels;
+	if ((bytes_per_pixel != 3 && bytes_per_pixel != 4) || image.len != n_pixels*bytes_per_pixel) {
+		PyErr_SetString(PyExc_ValueError, "image must be width*width pixels of 3 or 4 bytes");
+		goto done;
+	}
+	if (n_points < 0) n_points = d0 < (unsigned long long)n_pixels ? n_pixels - d0 : 0;
+	if (d0 > (unsigned long long)n_pixels || (unsigned long long)n_points > n_pixels - d0) {
+		PyErr_SetString(PyExc_ValueError, "points past the end of the image");
+		goto done;
+	}
+	uint8_t* out;
+	PyObject* bytes = new_bytes(n_points*N_COMP, &out);
+	if (bytes == NULL) goto done;
+	Py_BEGIN_ALLOW_THREADS
+	uncurl_flatten(image.buf, width_log2, width*bytes_per_pixel, bytes_per_pixel, d0, n_points, out);
+	Py_END_ALLOW_THREADS
+	result = PyMemoryView_FromObject(bytes);
+	Py_DECREF(bytes);
+done:
+	PyBuffer_Release(&image);
+	return result;
+}
+
+PyDoc_STRVAR(d2xy_doc,
+"d2xy(width_log2, d)\n"
+"\n"
+"Converts a buffer of uint64 1D coordinates into x and y; returns a (n, 2)\n"
+"uint32 memoryview. Misaligned buffers are copied first.");
+
+static PyObject* py_d2xy(PyObject* self, PyObject* args)
+{
+	int width_log2;
+	Py_buffer d;
+	if (!PyArg_ParseTuple(args, "iy*", &width_log2, &d)) return NULL;
+	PyObject* result = NULL;
+	uint32_t* xs = NULL;
+	uint32_t* ys = NULL;
+	void* d_copy = NULL;
+	if (width_log2 < 0 || width_log2 > 31 || (d.len % sizeof(uint64_t)) != 0) {
+		PyErr_SetString(PyExc_ValueError, "expected width_log2 in [0;31] and a buffer of uint64");
+		goto done;
+	}
+	const Py_ssize_t n = d.len / sizeof(uint64_t);
+	const uint64_t* ds = aligned_buf(&d, sizeof(uint64_t), &d_copy);
+	if (ds == NULL) goto done;
+	uint8_t* out;
+	PyObject* bytes = new_bytes(n * 2*sizeof(uint32_t), &out);
+	if (bytes == NULL) goto done;
+	xs = PyMem_RawMalloc(n * sizeof xs[0] + 1);
+	ys = PyMem_RawMalloc(n * sizeof ys[0] + 1);
+	if (xs == NULL || ys == NULL) {
+		Py_DECREF(bytes);
+		PyErr_NoMemory();
+		goto done;
+	}
+	Py_BEGIN_ALLOW_THREADS
+	uncurl_d2xy(width_log2, n, ds, xs, ys);
+	uint32_t* wp = (uint32_t*)out;
+	for (Py_ssize_t i = 0; i < n; i++) {
+		*(wp++) = xs[i];
+		*(wp++) = ys[i];
+	}
+	Py_END_ALLOW_THREADS
+	const Py_ssize_t shape[] = {n, 2};
+	result = shaped_view(bytes, "I", 2, shape);
+done:
+	PyMem_RawFree(xs);
+	PyMem_RawFree(ys);
+	PyMem_RawFree(d_copy);
+	PyBuffer_Release(&d);
+	return result;
+}
+
+PyDoc_STRVAR(xy2d_doc,
+"xy2d(width_log2, x, y)\n"
+"\n"
+"Converts buffers of uint32 x and y into 1D coordinates; returns a uint64\n"
+"memoryview. Misaligned buffers are copied first.");
+
+static PyObject* py_xy2d(PyObject* self, PyObject* args)
+{
+	int width_log2;
+	Py_buffer x, y;
+	if (!PyArg_ParseTuple(args, "iy*y*", &width_log2, &x, &y)) return NULL;
+	PyObject* result = NULL;
+	void* x_copy = NULL;
+	void* y_copy = NULL;
+	if (width_log2 < 0 || width_log2 > 31 || x.len != y.len || (x.len % sizeof(uint32_t)) != 0) {
+		PyErr_SetString(PyExc_ValueError, "expected width_log2 in [0;31] and two equally long buffers of uint32");
+		goto done;
+	}
+	const Py_ssize_t n = x.len / sizeof(uint32_t);
+	const uint32_t* xs = aligned_buf(&x, sizeof(uint32_t), &x_copy);
+	if (xs == NULL) goto done;
+	const uint32_t* ys = aligned_buf(&y, sizeof(uint32_t), &y_copy);
+	if (ys == NULL) goto done;
+	uint8_t* out;
+	PyObject* bytes = new_bytes(n * sizeof(uint64_t), &out);
+	if (bytes == NULL) goto done;
+	Py_BEGIN_ALLOW_THREADS
+	uncurl_xy2d(width_log2, n, xs, ys, (uint64_t*)out);
+	Py_END_ALLOW_THREADS
+	const Py_ssize_t shape[] = {n};
+	result = shaped_view(bytes, "Q", 1, shape);
+done:
+	PyMem_RawFree(x_copy);
+	PyMem_RawFree(y_copy);
+	PyBuffer_Release(&x);
+	PyBuffer_Release(&y);
+	return result;
+}
+
+static PyObject* py_width_log2_for_length(PyObject* self, PyObject* arg)
+{
+	const size_t n_points = PyLong_AsSize_t(arg);
+	if (n_points == (size_t)-1 && PyErr_Occurred()) return NULL;
+	return PyLong_FromLong(uncurl_width_log2_for_length(n_points));
+}
+
+static PyMethodDef uncurl_methods[] = {
+	{"curl", (PyCFunction)(void(*)(void))py_curl, METH_VARARGS | METH_KEYWORDS, curl_doc},
+	{"flatten", (PyCFunction)(void(*)(void))py_flatten, METH_VARARGS | METH_KEYWORDS, flatten_doc},
+	{"d2xy", py_d2xy, METH_VARARGS, d2xy_doc},
+	{"xy2d", py_xy2d, METH_VARARGS, xy2d_doc},
+	{"width_log2_for_length", py_width_log2_for_length, METH_O, "smallest width_log2 that fits n_points"},
+	{NULL, NULL, 0, NULL},
+};
+
+static struct PyModuleDef uncurl_module = {
+	PyModuleDef_HEAD_INIT,
+	.m_name = "uncurl",
+	.m_doc = "curls 1D RGB streams into 2D along a Hilbert curve",
+	.m_size = -1,
+	.m_methods = uncurl_methods,
+};
+
+PyMODINIT_FUNC PyInit_uncurl(void)
+{
+	return PyModule_Create(&uncurl_module);
+}
@@ -0,0 +1,265 @@
+// checks for libuncurl ("make check"): the curve kernels against each other
+// and the permutation, rasterization against its inverse, and the typed
+// value scan against a scalar reference. exits with EXIT_FAILURE on the
+// first failing check.
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "uncurl.h"
+
+#define N_COMP (UNCURL_N_COMP)
+
+static int n_failures;
+
+#define CHECK(COND, ...) \
+	do { \
+		if (!(COND)) { \
+			fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+			fprintf(stderr, __VA_ARGS__); \
+			fprintf(stderr, "\n"); \
+			n_failures++; \
+			return; \
+		} \
+	} while (0)
+
+// xorshift; the checks are reproducible
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+static uint64_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return rng_state;
+}
+
+static uint8_t* random_bytes(size_t n)
+{
+	uint8_t* p = malloc(n > 0 ? n : 1);
+	if (p == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t i = 0; i < n; i++) p[i] = rng();
+	return p;
+}
+
+// every point of small curves, and random ones of big curves, survive
+// d2xy then xy2d; neighbouring points are neighbouring pixels
+static void check_d2xy_xy2d(void)
+{
+	for (int width_log2 = 0; width_log2 <= 32; width_log2++) {
+		const size_t n = width_log2 <= 9 ? (size_t)1 << (2*width_log2) : 1<<16;
+		uint64_t* d = malloc(n * sizeof d[0]);
+		uint64_t* d2 = malloc(n * sizeof d2[0]);
+		uint32_t* x = malloc(n * sizeof x[0]);
+		uint32_t* y = malloc(n * sizeof y[0]);
+		const uint64_t mask = width_log2 == 32 ? ~0ull : ((uint64_t)1 << (2*width_log2)) - 1;
+		for (size_t i = 0; i < n; i++) d[i] = width_log2 <= 9 ? i : rng() & mask;
+		uncurl_d2xy(width_log2, n, d, x, y);
+		uncurl_xy2d(width_log2, n, x, y, d2);
+		size_t n_bad = 0;
+		for (size_t i = 0; i < n; i++) n_bad += d[i] != d2[i];
+		if (width_log2 <= 9) {
+			for (size_t i = 1; i < n; i++) n_bad += abs((int)x[i] - (int)x[i-1]) + abs((int)y[i] - (int)y[i-1]) != 1;
+		}
+		free(d);
+		free(d2);
+		free(x);
+		free(y);
+		CHECK(n_bad == 0, "d2xy/xy2d at width_log2 %d: %zu bad points", width_log2, n_bad);
+	}
+}
+
+// the permutation puts each point where d2xy says, and uncurl_fill() with
+// it draws what uncurl_rasterize() does
+static void check_permutation(void)
+{
+	for (int width_log2 = 0; width_log2 <= 9; width_log2++) {
+		const size_t n_pixels = (size_t)1 << (2*width_log2);
+		const size_t n_points = n_pixels - n_pixels/3;
+		int32_t* reverse = uncurl_permutation_new(UNCURL_CURVE_TYPE_hilbert, width_log2, n_points);
+		CHECK(reverse != NULL, "no permutation at width_log2 %d", width_log2);
+		size_t n_bad = 0;
+		for (size_t i = 0; i < n_pixels; i++) {
+			const uint32_t x = i & ((1<<width_log2)-1), y = i >> width_log2;
+			uint64_t d;
+			uncurl_xy2d(width_log2, 1, &x, &y, &d);
+			n_bad += reverse[i] != (d < n_points ? (int64_t)d : -1);
+		}
+		uint8_t* data = random_bytes(n_points * N_COMP);
+		uint8_t* filled = malloc(n_pixels * N_COMP);
+		uint8_t* rasterized = malloc(n_pixels * N_COMP);
+		uncurl_fill(filled, reverse, n_pixels, data);
+		uncurl_rasterize(data, n_points, width_log2, rasterized, (size_t)N_COMP << width_log2);
+		const int is_same = memcmp(filled, rasterized, n_pixels * N_COMP) == 0;
+		free(reverse);
+		free(data);
+		free(filled);
+		free(rasterized);
+		CHECK(n_bad == 0, "permutation at width_log2 %d: %zu bad pixels", width_log2, n_bad);
+		CHECK(is_same, "fill and rasterize differ at width_log2 %d", width_log2);
+	}
+}
+
+// uncurl_flatten() reads back what uncurl_rasterize() drew, from a padded
+// stride and from any starting point; pixels past the data are cleared
+static void check_rasterize_flatten(void)
+{
+	for (int width_log2 = 0; width_log2 <= 11; width_log2++) {
+		const size_t n_pixels = (size_t)1 << (2*width_log2);
+		const size_t n_points = n_pixels > 7 ? n_pixels - 7 : n_pixels;
+		const size_t stride = ((size_t)N_COMP << width_log2) + 5;
+		uint8_t* data = random_bytes(n_points * N_COMP);
+		uint8_t* image = random_bytes(stride << width_log2);
+		uint8_t* out = malloc(n_pixels * N_COMP);
+		uncurl_rasterize(data, n_points, width_log2, image, stride);
+		uncurl_flatten(image, width_log2, stride, N_COMP, 0, n_points, out);
+		const int is_same = memcmp(data, out, n_points * N_COMP) == 0;
+		const size_t d0 = n_points / 3;
+		uncurl_flatten(image, width_log2, stride, N_COMP, d0, n_points - d0, out);
+		const int is_same_from_d0 = memcmp(data + d0*N_COMP, out, (n_points - d0) * N_COMP) == 0;
+		uncurl_flatten(image, width_log2, stride, N_COMP, n_points, n_pixels - n_points, out);
+		size_t n_uncleared = 0;
+		for (size_t i = 0; i < (n_pixels - n_points) * N_COMP; i++) n_uncleared += out[i] != 0;
+		free(data);
+		free(image);
+		free(out);
+		CHECK(is_same, "rasterize/flatten at width_log2 %d", width_log2);
+		CHECK(is_same_from_d0, "rasterize/flatten from d0 at width_log2 %d", width_log2);
+		CHECK(n_uncleared == 0, "%zu bytes past the data not cleared at width_log2 %d", n_uncleared, width_log2);
+	}
+}
+
+static int value_matches(const uint8_t* p, const struct uncurl_value_query* q)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < q->width; i++) v |= (uint64_t)p[q->is_be ? q->width-1-i : i] << (8*i);
+	if (q->type == UNCURL_VALUE_UNSIGNED) return q->lo.u <= v && v <= q->hi.u;
+	if (q->type == UNCURL_VALUE_SIGNED) {
+		const int shift = 64 - 8*q->width;
+		const int64_t s = (int64_t)(v << shift) >> shift;
+		return q->lo.i <= s && s <= q->hi.i;
+	}
+	double f;
+	if (q->width == 4) {
+		uint32_t u = v;
+		float ff;
+		memcpy(&ff, &u, sizeof ff);
+		f = ff;
+	} else {
+		memcpy(&f, &v, sizeof f);
+	}
+	if (q->is_nan) return isnan(f);
+	return q->lo.f <= f && f <= q->hi.f;
+}
+
+static void random_query(struct uncurl_value_query* q)
+{
+	static const int widths[] = { 1, 2, 4, 8 };
+	memset(q, 0, sizeof *q);
+	q->type = rng() % 3;
+	q->width = q->type == UNCURL_VALUE_FLOAT ? widths[2 + rng() % 2] : widths[rng() % 4];
+	q->is_be = rng() & 1;
+	q->alignment = (size_t)1 << (rng() % 5);
+	const int bits = 8*q->width;
+	if (q->type == UNCURL_VALUE_UNSIGNED) {
+		// ranges around small and around random values
+		const uint64_t all = ~0ull >> (64 - bits);
+		const uint64_t a = (rng() & 1) ? rng() & 0xff : rng() & all;
+		const uint64_t b = a + (rng() & ((all >> 2) | 0xff));
+		q->lo.u = a;
+		q->hi.u = b >= a ? b : ~0ull;
+	} else if (q->type == UNCURL_VALUE_SIGNED) {
+		const int64_t max = (int64_t)(~0ull >> (65 - bits));
+		const int64_t a = (int64_t)(rng() % (2*(uint64_t)(max/2) + 1)) - max/2;
+		q->lo.i = a;
+		q->hi.i = a + (int64_t)(rng() % ((uint64_t)max/2 + 1));
+	} else if (rng() % 8 == 0) {
+		q->is_nan = 1;
+	} else {
+		const double a = ldexp((double)(int64_t)rng() / 9.3e18, (int)(rng() % 64) - 32);
+		q->lo.f = a;
+		q->hi.f = a + fabs(a) * (double)(rng() % 100);
+	}
+}
+
+// per-block counts and totals against a loop over every aligned offset
+static void check_values_count(void)
+{
+	const size_t size = (1<<20) + 13;
+	uint8_t* data = random_bytes(size);
+	// runs of small values, so narrow ranges hit something too
+	for (size_t i = 0; i < size; i += 1 + rng() % 64) data[i] &= 3;
+	const size_t block_size = 3 << 10;
+	const size_t n_blocks = (size + block_size - 1) / block_size;
+	uint32_t* counts = malloc(n_blocks * sizeof counts[0]);
+	uint32_t* ref = malloc(n_blocks * sizeof ref[0]);
+	for (int k = 0; k < 300; k++) {
+		struct uncurl_value_query q;
+		random_query(&q);
+		memset(ref, 0, n_blocks * sizeof ref[0]);
+		int64_t ref_total = 0;
+		for (size_t o = 0; o + q.width <= size; o += q.alignment) {
+			if (!value_matches(data + o, &q)) continue;
+			ref[o / block_size]++;
+			ref_total++;
+		}
+		const int64_t total = uncurl_values_count(data, size, &q, block_size, counts);
+		const int64_t total_only = uncurl_values_count(data, size, &q, block_size, NULL);
+		const int is_same = memcmp(counts, ref, n_blocks * sizeof ref[0]) == 0;
+		if (total != ref_total || total_only != ref_total || !is_same) {
+			free(data);
+			free(counts);
+			free(ref);
+		}
+		CHECK(total == ref_total && total_only == ref_total, "values query %d (type %d, width %d, alignment %zu): %lld hits, expected %lld", k, (int)q.type, q.width, q.alignment, (long long)total, (long long)ref_total);
+		CHECK(is_same, "values query %d (type %d, width %d, alignment %zu): per-block counts differ", k, (int)q.type, q.width, q.alignment);
+	}
+	free(data);
+	free(counts);
+	free(ref);
+}
+
+// bad arguments are errors, not aborts
+static void check_errors(void)
+{
+	CHECK(uncurl_permutation_new(UNCURL_CURVE_TYPE_hilbert, 16, 1) == NULL, "permutation too wide for int32");
+	CHECK(uncurl_permutation_new(UNCURL_CURVE_TYPE_hilbert, -1, 1) == NULL, "permutation of negative width_log2");
+	uint8_t data[64] = {0};
+	uint8_t out[64];
+	CHECK(uncurl_compressibility(data, sizeof data, 0, out) == -1, "compressibility with block_size 0");
+	CHECK(uncurl_compressibility(data, sizeof data, UNCURL_COMPRESS_BLOCK_MAX+1, out) == -1, "compressibility with a huge block_size");
+	CHECK(uncurl_compressibility(data, sizeof data, 16, out) == 0, "compressibility with a good block_size");
+	size_t n;
+	CHECK(uncurl_strings_find(data, sizeof data, 0, &n) == NULL, "strings with min_length 0");
+	struct uncurl_value_query q = { .type = UNCURL_VALUE_UNSIGNED, .width = 3, .alignment = 1 };
+	CHECK(uncurl_values_count(data, sizeof data, &q, 16, NULL) == -1, "values of width 3");
+	q.width = 4;
+	q.alignment = 3;
+	CHECK(uncurl_values_count(data, sizeof data, &q, 16, NULL) == -1, "values at alignment 3");
+	q.alignment = 4;
+	CHECK(uncurl_values_count(data, sizeof data, &q, 0, NULL) == -1, "values in blocks of 0");
+	q.type = UNCURL_VALUE_FLOAT;
+	q.width = 2;
+	q.alignment = 2;
+	CHECK(uncurl_values_count(data, sizeof data, &q, 16, NULL) == -1, "16-bit floats");
+}
+
+int main(void)
+{
+	check_d2xy_xy2d();
+	check_permutation();
+	check_rasterize_flatten();
+	check_values_count();
+	check_errors();
+	if (n_failures > 0) {
+		fprintf(stderr, "%d check(s) failed\n", n_failures);
+		return EXIT_FAILURE;
+	}
+	printf("all checks passed\n");
+	return EXIT_SUCCESS;
+}